@@ -1,13 +1,66 @@
 #include "benchmark/benchmark.h"
+#include "orderbooks/adaptive_orderbook.h"
 #include "orderbooks/binary_search_orderbook.h"
 #include "orderbooks/boost_flat_map_orderbook.h"
 #include "orderbooks/dro_flat_map_orderbook.h"
+#include "orderbooks/gap_buffer_orderbook.h"
+#include "orderbooks/heap_ankerl_hashmap_orderbook.h"
+#include "orderbooks/l3_orderbook.h"
 #include "orderbooks/linear_search_orderbook.h"
+#include "orderbooks/matching_engine.h"
+#include "orderbooks/paged_ladder_orderbook.h"
 #include "orderbooks/std_map_ankerl_hashmap_orderbook.h"
 #include "orderbooks/std_map_orderbook.h"
+#include "orderbooks/tombstone_orderbook.h"
+#include "orderbooks/truncated_dro_flat_map_orderbook.h"
+#include "l3_sample_data_generator.hpp"
+#include "matching_sample_data_generator.hpp"
 #include "sample_data_generator.hpp"
 
+#include <malloc.h>
+
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// Bytes malloc has handed out and not taken back, chunk overhead and mmapped
+// blocks included. Read from glibc's arena statistics rather than hooking
+// operator new, which would tax every allocation in every timed loop
+std::size_t
+live_heap_bytes()
+{
+  const struct mallinfo2 info = ::mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// Heap bytes held since construction, e.g. by a book built after it
+class HeapMeter {
+ private:
+  std::size_t start_{live_heap_bytes()};
+
+ public:
+  [[nodiscard]] double bytes() const
+  {
+    return static_cast<double>(live_heap_bytes())
+           - static_cast<double>(start_);
+  }
+};
+
+// Books constructed with a tick size take the sparse profile's
+template <typename Orderbook>
+Orderbook
+make_sparse_book()
+{
+  if constexpr (std::is_constructible_v<Orderbook, double>) {
+    return Orderbook{gkp::SampleDataGenerator<Orderbook>::SPARSE_TICK_SIZE};
+  } else {
+    return Orderbook{};
+  }
+}
+}  // namespace
 
 static void
 BM_stdMap_Orderbook(benchmark::State& state)
@@ -85,12 +138,328 @@ BM_DroFlatMap_Orderbook(benchmark::State& state)
   using namespace gkp;
   SampleDataGenerator<DroFlatMapOrderbook> data{
       static_cast<size_t>(state.range(0))};
+  const HeapMeter heap;
   DroFlatMapOrderbook book;
   data.set_snapshot_price_levels(book);
   // run benchmark
   for (auto _ : state) {
     data.perform_sample_L2_messages(book);
   }
+  state.counters["bytes"] = heap.bytes();
+}
+
+static void
+BM_Tombstone_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<TombstoneOrderbook> data{
+      static_cast<size_t>(state.range(0))};
+  TombstoneOrderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L2_messages(book);
+  }
+}
+
+static void
+BM_GapBuffer_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<GapBufferOrderbook> data{
+      static_cast<size_t>(state.range(0))};
+  GapBufferOrderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L2_messages(book);
+  }
+}
+
+static void
+BM_HeapAnkerl_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<HeapAnkerlOrderbook> data{
+      static_cast<size_t>(state.range(0))};
+  HeapAnkerlOrderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L2_messages(book);
+  }
+}
+
+static void
+BM_PagedLadder_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<PagedLadderOrderbook> data{
+      static_cast<size_t>(state.range(0))};
+  const HeapMeter heap;
+  PagedLadderOrderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L2_messages(book);
+  }
+  state.counters["bytes"] = heap.bytes();
+}
+
+static void
+BM_Adaptive_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<AdaptiveOrderbook> data{
+      static_cast<size_t>(state.range(0))};
+  AdaptiveOrderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L2_messages(book);
+  }
+}
+
+// Top of book read after every update
+template <typename Orderbook>
+static void
+BM_BboReads_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        data.perform_sample_L2_messages_with_bbo_reads(book));
+  }
+}
+
+// Prices clustered around the touch
+template <typename Orderbook>
+static void
+BM_TouchBiased_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_touch_biased_L2_messages(book);
+  }
+}
+
+// Levels spread thinly over a wide range of cent ticks
+template <typename Orderbook>
+static void
+BM_Sparse_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  const HeapMeter heap;
+  Orderbook book = make_sparse_book<Orderbook>();
+  data.set_sparse_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sparse_L2_messages(book);
+  }
+  state.counters["bytes"] = heap.bytes();
+}
+
+// Erase heavy profile, 1/2 of the messages are erases
+template <typename Orderbook>
+static void
+BM_EraseHeavy_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  constexpr std::size_t erase_denominator = 2;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0)),
+                                      erase_denominator};
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L2_messages(book);
+  }
+}
+
+// Erase and re-add at the same price
+template <typename Orderbook>
+static void
+BM_Churn_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_churn_L2_messages(book);
+  }
+}
+
+// Sweep of the levels at the touch, one erase per level
+template <typename Orderbook>
+static void
+BM_Sweep_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sweep_L2_messages(book);
+  }
+}
+
+// Same sweep with a single range erase
+template <typename Orderbook>
+static void
+BM_SweepEraseThrough_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sweep_erase_through(book);
+  }
+}
+
+// Levels held and changes dropped by a depth-limited book, nothing for a
+// whole one
+template <typename Orderbook>
+static void
+set_depth_counters(benchmark::State& state, const Orderbook& book,
+                   const double resnapshots)
+{
+  if constexpr (requires { book.dropped_updates(); }) {
+    state.counters["levels"]      = static_cast<double>(book.size());
+    state.counters["dropped"]     = static_cast<double>(book.dropped_updates());
+    state.counters["resnapshots"] = resnapshots;
+  }
+}
+
+// Top K levels retained out of the full snapshot, registered beside the whole
+// DroFlatMapOrderbook for comparison. resnapshots counts the batches that left
+// the retained window thinner than a consumer reads
+template <typename Orderbook>
+static void
+BM_Truncated_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  const HeapMeter heap;
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  double resnapshots{};
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L2_messages(book);
+    if constexpr (requires { book.needs_resnapshot(); }) {
+      resnapshots += book.needs_resnapshot() ? 1.0 : 0.0;
+    }
+  }
+  state.counters["bytes"] = heap.bytes();
+  set_depth_counters(state, book, resnapshots);
+}
+
+// Same comparison with prices clustered around the touch
+template <typename Orderbook>
+static void
+BM_TruncatedTouchBiased_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  SampleDataGenerator<Orderbook> data{static_cast<size_t>(state.range(0))};
+  const HeapMeter heap;
+  Orderbook book;
+  data.set_snapshot_price_levels(book);
+  double resnapshots{};
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_touch_biased_L2_messages(book);
+    if constexpr (requires { book.needs_resnapshot(); }) {
+      resnapshots += book.needs_resnapshot() ? 1.0 : 0.0;
+    }
+  }
+  state.counters["bytes"] = heap.bytes();
+  set_depth_counters(state, book, resnapshots);
+}
+
+// Order by order add, cancel, execute and modify mix
+template <typename Orderbook>
+static void
+BM_L3_Orderbook(benchmark::State& state)
+{
+  using namespace gkp;
+  const auto order_qty = static_cast<size_t>(state.range(0));
+  L3SampleDataGenerator<Orderbook> data{order_qty};
+  Orderbook book{2 * order_qty};
+  data.set_snapshot_orders(book);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_sample_L3_messages(book);
+  }
+  state.counters["orders"] = static_cast<double>(book.order_count());
+  state.counters["levels"] = static_cast<double>(book.level_count());
+}
+
+// Matching throughput over the order flow, items are orders and cancels
+template <typename Orderbook>
+static void
+BM_Matching_Engine(benchmark::State& state)
+{
+  using namespace gkp;
+  using Engine         = MatchingEngine<Orderbook>;
+  const auto order_qty = static_cast<size_t>(state.range(0));
+  MatchingSampleDataGenerator<Engine> data{order_qty};
+  Engine engine{2 * order_qty};
+  data.set_resting_orders(engine);
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_matching_messages(engine);
+  }
+  state.SetItemsProcessed(state.iterations()
+                          * static_cast<int64_t>(data.iterations()));
+  state.counters["fills"] = benchmark::Counter(
+      static_cast<double>(data.fills()), benchmark::Counter::kAvgIterations);
+}
+
+// Order to last fill latency of the orders taking liquidity, in ns
+template <typename Orderbook>
+static void
+BM_Matching_Latency(benchmark::State& state)
+{
+  using namespace gkp;
+  using Engine         = MatchingEngine<Orderbook>;
+  const auto order_qty = static_cast<size_t>(state.range(0));
+  MatchingSampleDataGenerator<Engine> data{order_qty};
+  Engine engine{2 * order_qty};
+  data.set_resting_orders(engine);
+  std::vector<int64_t> latencies;
+  latencies.reserve(static_cast<std::size_t>(state.max_iterations)
+                    * data.timed_per_call());
+  // run benchmark
+  for (auto _ : state) {
+    data.perform_matching_messages(engine, &latencies);
+  }
+  if (latencies.empty()) {
+    return;
+  }
+  auto percentile = [&latencies](const double rank) {
+    const auto index = static_cast<std::size_t>(
+        rank * static_cast<double>(latencies.size() - 1));
+    std::nth_element(latencies.begin(),
+                     latencies.begin() + static_cast<std::ptrdiff_t>(index),
+                     latencies.end());
+    return static_cast<double>(latencies[index]);
+  };
+  state.counters["p50_ns"] = percentile(0.5);
+  state.counters["p99_ns"] = percentile(0.99);
 }
 
 constexpr static uint32_t begin_size = 1 << 7;
@@ -110,6 +479,180 @@ BENCHMARK(BM_BoostFlatMap_Orderbook)
     ->RangeMultiplier(2)
     ->Range(begin_size, end_size);
 
+BENCHMARK(BM_Tombstone_Orderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK(BM_GapBuffer_Orderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK(BM_HeapAnkerl_Orderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK(BM_PagedLadder_Orderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK(BM_Adaptive_Orderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+// Top Of Book Read Profiles
+BENCHMARK_TEMPLATE(BM_BboReads_Orderbook, gkp::HeapAnkerlOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_BboReads_Orderbook, gkp::stdMapAnkerlOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_BboReads_Orderbook, gkp::DroFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+// Touch Biased Profiles
+BENCHMARK_TEMPLATE(BM_TouchBiased_Orderbook, gkp::GapBufferOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_TouchBiased_Orderbook, gkp::DroFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_TouchBiased_Orderbook, gkp::AdaptiveOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+// Sparse Wide Range Profiles
+BENCHMARK_TEMPLATE(BM_Sparse_Orderbook, gkp::PagedLadderOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Sparse_Orderbook, gkp::DroFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+// Erase Heavy Profiles
+BENCHMARK_TEMPLATE(BM_EraseHeavy_Orderbook, gkp::TombstoneOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_EraseHeavy_Orderbook, gkp::DroFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_EraseHeavy_Orderbook, gkp::BoostFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_EraseHeavy_Orderbook, gkp::AdaptiveOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Churn_Orderbook, gkp::TombstoneOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Churn_Orderbook, gkp::DroFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Churn_Orderbook, gkp::BoostFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+// Sweep Profiles
+BENCHMARK_TEMPLATE(BM_Sweep_Orderbook, gkp::stdMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_SweepEraseThrough_Orderbook, gkp::stdMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Sweep_Orderbook, gkp::DroFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_SweepEraseThrough_Orderbook, gkp::DroFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Sweep_Orderbook, gkp::BoostFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_SweepEraseThrough_Orderbook, gkp::BoostFlatMapOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Sweep_Orderbook, gkp::TombstoneOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_SweepEraseThrough_Orderbook, gkp::TombstoneOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Sweep_Orderbook, gkp::GapBufferOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_SweepEraseThrough_Orderbook, gkp::GapBufferOrderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+// Depth Limited Profiles, K = 50/500/5000 against the whole book
+BENCHMARK_TEMPLATE(BM_Truncated_Orderbook,
+                   gkp::TruncatedDroFlatMapOrderbook<50>)
+    ->Arg(end_size);
+BENCHMARK_TEMPLATE(BM_Truncated_Orderbook,
+                   gkp::TruncatedDroFlatMapOrderbook<500>)
+    ->Arg(end_size);
+BENCHMARK_TEMPLATE(BM_Truncated_Orderbook,
+                   gkp::TruncatedDroFlatMapOrderbook<5000>)
+    ->Arg(end_size);
+BENCHMARK_TEMPLATE(BM_Truncated_Orderbook, gkp::DroFlatMapOrderbook)
+    ->Arg(end_size);
+
+BENCHMARK_TEMPLATE(BM_TruncatedTouchBiased_Orderbook,
+                   gkp::TruncatedDroFlatMapOrderbook<50>)
+    ->Arg(end_size);
+BENCHMARK_TEMPLATE(BM_TruncatedTouchBiased_Orderbook,
+                   gkp::TruncatedDroFlatMapOrderbook<500>)
+    ->Arg(end_size);
+BENCHMARK_TEMPLATE(BM_TruncatedTouchBiased_Orderbook,
+                   gkp::TruncatedDroFlatMapOrderbook<5000>)
+    ->Arg(end_size);
+BENCHMARK_TEMPLATE(BM_TruncatedTouchBiased_Orderbook, gkp::DroFlatMapOrderbook)
+    ->Arg(end_size);
+
+BENCHMARK_TEMPLATE(BM_L3_Orderbook, gkp::DroFlatMapL3Orderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_L3_Orderbook, gkp::stdMapL3Orderbook)
+    ->RangeMultiplier(2)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Matching_Engine, gkp::DroFlatMapL3Orderbook)
+    ->RangeMultiplier(4)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Matching_Engine, gkp::stdMapL3Orderbook)
+    ->RangeMultiplier(4)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Matching_Latency, gkp::DroFlatMapL3Orderbook)
+    ->RangeMultiplier(4)
+    ->Range(begin_size, end_size);
+
+BENCHMARK_TEMPLATE(BM_Matching_Latency, gkp::stdMapL3Orderbook)
+    ->RangeMultiplier(4)
+    ->Range(begin_size, end_size);
+
 // BENCHMARK(BM_LinearSearch_Orderbook)
 //     ->RangeMultiplier(2)
 //    ->Range(begin_size, end_size);
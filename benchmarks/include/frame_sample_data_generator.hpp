@@ -0,0 +1,103 @@
+#include <cstddef>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gkp {
+
+// Synthesized Coinbase level2 frames in the exact compact form the feed
+// sends, prices with 2 decimals and sizes with 8, so parsers can be compared
+// without a network connection.
+class FrameSampleDataGenerator {
+ private:
+  // Change these user defined constants
+  constexpr static std::size_t FRAME_QTY        = 1'000;
+  constexpr static std::size_t MAX_CHANGES      = 10;
+  constexpr static std::size_t SNAPSHOT_LEVELS  = 1'000;
+  constexpr static std::size_t initial_best_ask = 10'000'100;
+  constexpr static std::size_t initial_best_bid = 10'000'000;
+  // Success probability of the touch distance, in cents
+  constexpr static double TOUCH_PROBABILITY     = 0.05;
+
+  // Preset random devices
+  std::minstd_rand generator{0};
+  std::uniform_int_distribution<std::size_t> changes_distribution{
+      1, MAX_CHANGES};
+  std::uniform_int_distribution<std::size_t> size_distribution{0,
+                                                               500'000'000};
+  std::geometric_distribution<std::size_t> touch_distance_distribution{
+      TOUCH_PROBABILITY};
+
+  // Fixed point value with decimals digits after the point
+  static void append_fixed(std::string& frame, const std::size_t value,
+                           const std::size_t decimals)
+  {
+    std::size_t scale = 1;
+    for (std::size_t i{}; i < decimals; ++i) {
+      scale *= 10;
+    }
+    frame += std::to_string(value / scale);
+    frame += '.';
+    const std::string fraction = std::to_string(value % scale);
+    frame.append(decimals - fraction.size(), '0');
+    frame += fraction;
+  }
+
+  // Price in cents
+  void append_level(std::string& frame, const std::size_t price)
+  {
+    frame += "\"";
+    append_fixed(frame, price, 2);
+    frame += "\",\"";
+    // Removes are a quarter of the changes
+    const std::size_t size =
+        (generator() % 4 == 0) ? 0 : size_distribution(generator);
+    append_fixed(frame, size, 8);
+    frame += "\"";
+  }
+
+ public:
+  [[nodiscard]] std::vector<std::string> l2update_frames()
+  {
+    std::vector<std::string> frames;
+    frames.reserve(FRAME_QTY);
+    for (std::size_t i{}; i < FRAME_QTY; ++i) {
+      std::string frame{
+          R"({"type":"l2update","product_id":"BTC-USD","changes":[)"};
+      const std::size_t changes = changes_distribution(generator);
+      for (std::size_t change{}; change < changes; ++change) {
+        const bool bid             = (generator() & 1) != 0;
+        const std::size_t distance = touch_distance_distribution(generator);
+        frame += (change == 0) ? "[" : ",[";
+        frame += bid ? R"("buy",)" : R"("sell",)";
+        append_level(frame, bid ? initial_best_bid - distance
+                                : initial_best_ask + distance);
+        frame += "]";
+      }
+      frame += R"(],"time":"2024-11-17T20:42:27.265819Z"})";
+      frames.push_back(std::move(frame));
+    }
+    return frames;
+  }
+
+  [[nodiscard]] std::string snapshot_frame()
+  {
+    std::string frame{
+        R"({"type":"snapshot","product_id":"BTC-USD","bids":[)"};
+    for (std::size_t level{}; level < SNAPSHOT_LEVELS; ++level) {
+      frame += (level == 0) ? "[" : ",[";
+      append_level(frame, initial_best_bid - level);
+      frame += "]";
+    }
+    frame += R"(],"asks":[)";
+    for (std::size_t level{}; level < SNAPSHOT_LEVELS; ++level) {
+      frame += (level == 0) ? "[" : ",[";
+      append_level(frame, initial_best_ask + level);
+      frame += "]";
+    }
+    frame += "]}";
+    return frame;
+  }
+};
+}  // namespace gkp
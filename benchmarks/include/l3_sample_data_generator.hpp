@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace gkp {
+
+// Order by order messages. Most orders are cancelled before they trade, a
+// few execute at the touch and a few are modified, which is roughly what the
+// public ITCH style feeds show. Prices cluster around the touch.
+template <typename Orderbook>
+class L3SampleDataGenerator {
+ private:
+  // Change these user defined constants
+  std::size_t ORDER_QTY;
+  constexpr static std::size_t ITERATIONS       = 10'000;
+  constexpr static std::size_t ORDERS_PER_LEVEL = 4;
+  // Message mix in percent, the rest are adds
+  constexpr static std::size_t CANCEL_PERCENT   = 40;
+  constexpr static std::size_t EXECUTE_PERCENT  = 8;
+  constexpr static std::size_t MODIFY_PERCENT   = 4;
+  constexpr static std::size_t MAX_QUANTITY     = 8;
+  constexpr static std::size_t initial_best_ask = 100'001;
+  constexpr static std::size_t initial_best_bid = 100'000;
+  // Success probability of the touch distance, mean distance is ~1/p levels
+  constexpr static double TOUCH_PROBABILITY     = 0.125;
+
+  struct LiveOrder {
+    uint64_t id_{};
+    char buy_sell_{};
+    double price_{};
+  };
+
+  // Orders added and not yet cancelled here. Executions remove orders behind
+  // the generator's back, a later cancel of one is a miss like on the feed
+  std::vector<LiveOrder> live_;
+  uint64_t next_id_{1};
+  std::size_t level_qty_{1};
+  // Preset random devices
+  std::minstd_rand generator{0};
+  std::uniform_int_distribution<std::size_t> percent_distribution{0, 99};
+  std::uniform_int_distribution<std::size_t> quantity_distribution{
+      1, MAX_QUANTITY};
+  std::geometric_distribution<std::size_t> touch_distance_distribution{
+      TOUCH_PROBABILITY};
+
+  char get_random_buy_sell() { return (generator() & 1) ? 'b' : 's'; }
+
+  double get_touch_biased_price(const char& bid_ask)
+  {
+    const std::size_t distance =
+        touch_distance_distribution(generator) % level_qty_;
+    if (bid_ask == 'b') {
+      return static_cast<double>(initial_best_bid - distance);
+    }
+    return static_cast<double>(initial_best_ask + distance);
+  }
+
+  double get_random_quantity()
+  {
+    return static_cast<double>(quantity_distribution(generator));
+  }
+
+  // Swap removes, order in live_ doesn't matter
+  LiveOrder take_random_order()
+  {
+    const std::size_t index = generator() % live_.size();
+    const LiveOrder order   = live_[index];
+    live_[index]            = live_.back();
+    live_.pop_back();
+    return order;
+  }
+
+  void add(Orderbook& book)
+  {
+    const char buy_sell = get_random_buy_sell();
+    const double price  = get_touch_biased_price(buy_sell);
+    book.add_order(next_id_, buy_sell, price, get_random_quantity());
+    live_.push_back(LiveOrder{next_id_++, buy_sell, price});
+  }
+
+  void cancel(Orderbook& book)
+  {
+    if (!live_.empty()) {
+      book.cancel_order(take_random_order().id_);
+    }
+  }
+
+  // Aggressive order against the oldest order at the touch
+  void execute(Orderbook& book)
+  {
+    const char buy_sell = get_random_buy_sell();
+    if (book.has_orders(buy_sell)) {
+      book.execute_order(book.front_order(buy_sell), get_random_quantity());
+    }
+  }
+
+  // Half shrink in place, half move to a new price
+  void modify(Orderbook& book)
+  {
+    if (live_.empty()) {
+      return;
+    }
+    const std::size_t index = generator() % live_.size();
+    LiveOrder& order        = live_[index];
+    if (generator() & 1) {
+      book.modify_order(order.id_, order.price_, 1.0);
+      return;
+    }
+    order.price_ = get_touch_biased_price(order.buy_sell_);
+    book.modify_order(order.id_, order.price_, get_random_quantity());
+  }
+
+ public:
+  explicit L3SampleDataGenerator(const std::size_t order_qty = 10'000)
+      : ORDER_QTY(order_qty),
+        level_qty_(std::max<std::size_t>(order_qty / ORDERS_PER_LEVEL, 1))
+  {
+    live_.reserve(2 * order_qty);
+  }
+
+  void set_snapshot_orders(Orderbook& book)
+  {
+    for (std::size_t i{}; i < ORDER_QTY; ++i) {
+      add(book);
+    }
+  }
+
+  void perform_sample_L3_messages(Orderbook& book)
+  {
+    for (std::size_t i{}; i < ITERATIONS; ++i) {
+      std::size_t percent = percent_distribution(generator);
+      if (percent < CANCEL_PERCENT) {
+        cancel(book);
+        continue;
+      }
+      percent -= CANCEL_PERCENT;
+      if (percent < EXECUTE_PERCENT) {
+        execute(book);
+        continue;
+      }
+      percent -= EXECUTE_PERCENT;
+      if (percent < MODIFY_PERCENT) {
+        modify(book);
+        continue;
+      }
+      // Hold the book around its snapshot size
+      if (live_.size() > ORDER_QTY) {
+        cancel(book);
+        continue;
+      }
+      add(book);
+    }
+  }
+};
+}  // namespace gkp
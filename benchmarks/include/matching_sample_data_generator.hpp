@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace gkp {
+
+// Order flow for a matching engine. Passive limit orders rest around the
+// touch and most are cancelled, while market, IOC and the occasional
+// marketable limit order take liquidity from the front of the queues.
+template <typename Engine>
+class MatchingSampleDataGenerator {
+ private:
+  // Change these user defined constants
+  std::size_t ORDER_QTY;
+  constexpr static std::size_t ITERATIONS         = 10'000;
+  constexpr static std::size_t ORDERS_PER_LEVEL   = 4;
+  // Message mix in percent, the rest are limit orders
+  constexpr static std::size_t CANCEL_PERCENT     = 40;
+  constexpr static std::size_t MARKET_PERCENT     = 4;
+  constexpr static std::size_t IOC_PERCENT        = 4;
+  // Limit orders priced through the touch
+  constexpr static std::size_t MARKETABLE_PERCENT = 5;
+  constexpr static std::size_t MAX_QUANTITY       = 8;
+  constexpr static std::size_t initial_best_ask   = 100'001;
+  constexpr static std::size_t initial_best_bid   = 100'000;
+  // Success probability of the touch distance, mean distance is ~1/p levels
+  constexpr static double TOUCH_PROBABILITY       = 0.125;
+
+  // Limit orders sent and not yet cancelled here, fills make some stale
+  std::vector<uint64_t> live_;
+  uint64_t next_id_{1};
+  std::size_t level_qty_{1};
+  std::size_t fills_{};
+  // Preset random devices
+  std::minstd_rand generator{0};
+  std::uniform_int_distribution<std::size_t> percent_distribution{0, 99};
+  std::uniform_int_distribution<std::size_t> quantity_distribution{
+      1, MAX_QUANTITY};
+  std::geometric_distribution<std::size_t> touch_distance_distribution{
+      TOUCH_PROBABILITY};
+
+  char get_random_buy_sell() { return (generator() & 1) ? 'b' : 's'; }
+
+  // Passive price on the order's own side of the book
+  double get_passive_price(const char& bid_ask)
+  {
+    const std::size_t distance =
+        touch_distance_distribution(generator) % level_qty_;
+    if (bid_ask == 'b') {
+      return static_cast<double>(initial_best_bid - distance);
+    }
+    return static_cast<double>(initial_best_ask + distance);
+  }
+
+  // A few levels into the contra side
+  double get_aggressive_price(const char& bid_ask)
+  {
+    const std::size_t distance = touch_distance_distribution(generator) % 4;
+    if (bid_ask == 'b') {
+      return static_cast<double>(initial_best_ask + distance);
+    }
+    return static_cast<double>(initial_best_bid - distance);
+  }
+
+  double get_random_quantity()
+  {
+    return static_cast<double>(quantity_distribution(generator));
+  }
+
+  struct Order {
+    uint64_t id_{};
+    char buy_sell_{};
+    OrderType type_{};
+    double price_{};
+    double quantity_{};
+  };
+
+  Order make_limit(const bool marketable)
+  {
+    const char buy_sell = get_random_buy_sell();
+    const double price  = marketable ? get_aggressive_price(buy_sell)
+                                     : get_passive_price(buy_sell);
+    return Order{next_id_++, buy_sell, OrderType::Limit, price,
+                 get_random_quantity()};
+  }
+
+  Order make_take(const OrderType type)
+  {
+    const char buy_sell = get_random_buy_sell();
+    return Order{next_id_++, buy_sell, type, get_aggressive_price(buy_sell),
+                 get_random_quantity()};
+  }
+
+  static void submit(Engine& engine, const Order& order)
+  {
+    engine.submit(order.id_, order.buy_sell_, order.type_, order.price_,
+                  order.quantity_);
+  }
+
+  void limit(Engine& engine, const bool marketable)
+  {
+    const Order order = make_limit(marketable);
+    submit(engine, order);
+    live_.push_back(order.id_);
+  }
+
+  void cancel(Engine& engine)
+  {
+    if (live_.empty()) {
+      return;
+    }
+    // Swap remove, order in live_ doesn't matter
+    const std::size_t index = generator() % live_.size();
+    engine.cancel(live_[index]);
+    live_[index] = live_.back();
+    live_.pop_back();
+  }
+
+ public:
+  explicit MatchingSampleDataGenerator(const std::size_t order_qty = 10'000)
+      : ORDER_QTY(order_qty),
+        level_qty_(std::max<std::size_t>(order_qty / ORDERS_PER_LEVEL, 1))
+  {
+    live_.reserve(2 * order_qty);
+  }
+
+  void set_resting_orders(Engine& engine)
+  {
+    for (std::size_t i{}; i < ORDER_QTY; ++i) {
+      limit(engine, false);
+    }
+  }
+
+  // With latencies set, every order that takes liquidity is timed from
+  // submit to its last fill, in nanoseconds
+  void perform_matching_messages(Engine& engine,
+                                 std::vector<int64_t>* latencies = nullptr)
+  {
+    for (std::size_t i{}; i < ITERATIONS; ++i) {
+      std::size_t percent = percent_distribution(generator);
+      if (percent < CANCEL_PERCENT) {
+        cancel(engine);
+        continue;
+      }
+      percent -= CANCEL_PERCENT;
+      const bool is_limit = percent >= MARKET_PERCENT + IOC_PERCENT;
+      const bool marketable =
+          is_limit && percent_distribution(generator) < MARKETABLE_PERCENT;
+      // Hold the book around its resting size
+      if (is_limit && !marketable && live_.size() > ORDER_QTY) {
+        cancel(engine);
+        continue;
+      }
+      const Order order =
+          is_limit ? make_limit(marketable)
+                   : make_take((percent < MARKET_PERCENT)
+                                   ? OrderType::Market
+                                   : OrderType::ImmediateOrCancel);
+      if (latencies != nullptr && (!is_limit || marketable)) {
+        const auto start = std::chrono::steady_clock::now();
+        submit(engine, order);
+        const auto end = std::chrono::steady_clock::now();
+        latencies->push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                .count());
+      } else {
+        submit(engine, order);
+      }
+      if (is_limit) {
+        live_.push_back(order.id_);
+      }
+      fills_ += engine.fills().size();
+    }
+  }
+
+  [[nodiscard]] std::size_t fills() const { return fills_; }
+
+  // Orders expected to take liquidity per perform_matching_messages call
+  [[nodiscard]] constexpr static std::size_t timed_per_call()
+  {
+    const std::size_t limit_percent =
+        100 - CANCEL_PERCENT - MARKET_PERCENT - IOC_PERCENT;
+    return ITERATIONS
+           * (100 * (MARKET_PERCENT + IOC_PERCENT)
+              + limit_percent * MARKETABLE_PERCENT)
+           / (100 * 100);
+  }
+
+  [[nodiscard]] constexpr static std::size_t iterations()
+  {
+    return ITERATIONS;
+  }
+};
+}  // namespace gkp
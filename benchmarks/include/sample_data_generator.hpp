@@ -10,15 +10,30 @@ class SampleDataGenerator {
   constexpr static std::size_t ITERATIONS       = 10'000;
   // Denominator in a fraction e.g. 1/4. This is the probability of an erase
   // occurring. Default is 1/4 or 25%.
-  constexpr static std::size_t DENOMINATOR      = 4;
+  std::size_t DENOMINATOR;
   constexpr static std::size_t initial_best_ask = 100'001;
   constexpr static std::size_t initial_best_bid = 100'000;
+  // Levels removed by one aggressive order sweeping the book
+  constexpr static std::size_t SWEEP_LEVELS     = 32;
+  // Success probability of the touch distance, mean distance is ~1/p levels
+  constexpr static double TOUCH_PROBABILITY     = 0.125;
+  // Sparse profile, LEVEL_QTY levels per side spread SPARSE_SPACING ticks
+  // apart. The touch is far enough from zero for the widest span
+  constexpr static std::size_t SPARSE_SPACING   = 64;
+  constexpr static std::size_t sparse_best_ask  = 10'000'001;
+  constexpr static std::size_t sparse_best_bid  = 10'000'000;
   // Preset random devices
   std::minstd_rand generator{0};
   std::uniform_int_distribution<std::size_t> bid_uniform_distribution{
-      initial_best_bid, initial_best_bid - LEVEL_QTY};
+      initial_best_bid - LEVEL_QTY, initial_best_bid};
   std::uniform_int_distribution<std::size_t> ask_uniform_distribution{
       initial_best_ask, initial_best_ask + LEVEL_QTY};
+  // Distance from the touch, most activity is within a few levels
+  std::geometric_distribution<std::size_t> touch_distance_distribution{
+      TOUCH_PROBABILITY};
+  // Any tick of the sparse span, most of them empty
+  std::uniform_int_distribution<std::size_t> sparse_distance_distribution{
+      0, LEVEL_QTY * SPARSE_SPACING};
 
   double get_random_price(const char& bid_ask)
   {
@@ -28,6 +43,40 @@ class SampleDataGenerator {
     return static_cast<double>(ask_uniform_distribution(generator));
   }
 
+  double get_touch_biased_price(const char& bid_ask)
+  {
+    const std::size_t distance =
+        touch_distance_distribution(generator) % LEVEL_QTY;
+    if (bid_ask == 'b') {
+      return static_cast<double>(initial_best_bid - distance);
+    }
+    return static_cast<double>(initial_best_ask + distance);
+  }
+
+  double get_sparse_price(const char& bid_ask, const std::size_t distance)
+  {
+    if (bid_ask == 'b') {
+      return static_cast<double>(sparse_best_bid - distance)
+             * SPARSE_TICK_SIZE;
+    }
+    return static_cast<double>(sparse_best_ask + distance) * SPARSE_TICK_SIZE;
+  }
+
+  double get_sweep_price(const char& bid_ask, const std::size_t level)
+  {
+    if (bid_ask == 'b') {
+      return static_cast<double>(initial_best_bid - level);
+    }
+    return static_cast<double>(initial_best_ask + level);
+  }
+
+  void refill_sweep(Orderbook& book, const char& bid_ask)
+  {
+    for (std::size_t level{}; level < SWEEP_LEVELS; ++level) {
+      book.update_book(bid_ask, get_sweep_price(bid_ask, level), 1.0);
+    }
+  }
+
   double get_random_quantity()
   {
     // The quantity doesn't matter so much, the important part is whether it's
@@ -43,9 +92,12 @@ class SampleDataGenerator {
   }
 
  public:
+  // Sparse profile prices are ticks of this size, e.g. cents
+  constexpr static double SPARSE_TICK_SIZE = 0.01;
 
-  explicit SampleDataGenerator(const std::size_t level_qty = 1'000)
-      : LEVEL_QTY(level_qty)
+  explicit SampleDataGenerator(const std::size_t level_qty   = 1'000,
+                               const std::size_t denominator = 4)
+      : LEVEL_QTY(level_qty), DENOMINATOR(denominator)
   {}
 
   void set_snapshot_price_levels(Orderbook& book)
@@ -62,6 +114,19 @@ class SampleDataGenerator {
     }
   }
 
+  // LEVEL_QTY levels per side over LEVEL_QTY * SPARSE_SPACING ticks
+  void set_sparse_snapshot_price_levels(Orderbook& book)
+  {
+    // Bid ///////////
+    for (std::size_t i{}; i < LEVEL_QTY; ++i) {
+      book.build_sides('b', get_sparse_price('b', i * SPARSE_SPACING), 1.0);
+    }
+    // Ask ///////////
+    for (std::size_t i{}; i < LEVEL_QTY; ++i) {
+      book.build_sides('s', get_sparse_price('s', i * SPARSE_SPACING), 1.0);
+    }
+  }
+
   void perform_sample_L2_messages(Orderbook& book)
   {
     for (std::size_t i{}; i < ITERATIONS; ++i) {
@@ -71,6 +136,80 @@ class SampleDataGenerator {
       book.update_book(buy_sell, price, quantity);
     }
   }
+
+  // Same message mix, reading the top of book after every update like the
+  // feed handler's crossed book check. Returns the crossed count so the reads
+  // can't be optimized away.
+  std::size_t perform_sample_L2_messages_with_bbo_reads(Orderbook& book)
+  {
+    std::size_t crossed{};
+    for (std::size_t i{}; i < ITERATIONS; ++i) {
+      const char buy_sell   = get_random_buy_sell();
+      const double price    = get_random_price(buy_sell);
+      const double quantity = get_random_quantity();
+      book.update_book(buy_sell, price, quantity);
+      crossed += static_cast<std::size_t>(book.is_crossed());
+    }
+    return crossed;
+  }
+
+  // Same message mix over the sparse span, most inserts land on empty ticks
+  void perform_sparse_L2_messages(Orderbook& book)
+  {
+    for (std::size_t i{}; i < ITERATIONS; ++i) {
+      const char buy_sell   = get_random_buy_sell();
+      const double price    = get_sparse_price(
+          buy_sell, sparse_distance_distribution(generator));
+      const double quantity = get_random_quantity();
+      book.update_book(buy_sell, price, quantity);
+    }
+  }
+
+  // Same message mix, with prices clustered around the touch
+  void perform_touch_biased_L2_messages(Orderbook& book)
+  {
+    for (std::size_t i{}; i < ITERATIONS; ++i) {
+      const char buy_sell   = get_random_buy_sell();
+      const double price    = get_touch_biased_price(buy_sell);
+      const double quantity = get_random_quantity();
+      book.update_book(buy_sell, price, quantity);
+    }
+  }
+
+  // A sweep removes SWEEP_LEVELS consecutive levels from the touch with one
+  // erase per level, as the feed reports it, then the book refills
+  void perform_sweep_L2_messages(Orderbook& book)
+  {
+    for (std::size_t i{}; i < ITERATIONS / (2 * SWEEP_LEVELS); ++i) {
+      const char buy_sell = get_random_buy_sell();
+      for (std::size_t level{}; level < SWEEP_LEVELS; ++level) {
+        book.update_book(buy_sell, get_sweep_price(buy_sell, level), 0.0);
+      }
+      refill_sweep(book, buy_sell);
+    }
+  }
+
+  // Same sweep, removed with a single erase_through call
+  void perform_sweep_erase_through(Orderbook& book)
+  {
+    for (std::size_t i{}; i < ITERATIONS / (2 * SWEEP_LEVELS); ++i) {
+      const char buy_sell = get_random_buy_sell();
+      book.erase_through(buy_sell, get_sweep_price(buy_sell, SWEEP_LEVELS - 1));
+      refill_sweep(book, buy_sell);
+    }
+  }
+
+  // Erase / re-add churn at the same price, e.g. a level that is pulled and
+  // immediately re-quoted. Every message pair removes a level and restores it.
+  void perform_churn_L2_messages(Orderbook& book)
+  {
+    for (std::size_t i{}; i < ITERATIONS / 2; ++i) {
+      const char buy_sell = get_random_buy_sell();
+      const double price  = get_random_price(buy_sell);
+      book.update_book(buy_sell, price, 0.0);
+      book.update_book(buy_sell, price, 1.0);
+    }
+  }
 };
 
 }
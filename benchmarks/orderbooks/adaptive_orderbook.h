@@ -0,0 +1,308 @@
+#pragma once
+// Header Guard
+
+#include "../../submodules/Flat-Map-RB-Tree/include/dro/flat-rb-tree.hpp"
+#include "helper/orderbook_level.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace gkp {
+
+// One side of the book that picks its own representation. Every
+// SAMPLE_WINDOW updates it samples the depth and migrates between a sorted
+// array (small books) and a flat map (everything deeper). The depths have a
+// gap between entering and leaving the array, and a new mode must win
+// CONFIRM_WINDOWS windows in a row before migrating. dro::FlatMap is already
+// a red-black tree with its nodes in a vector, a std::map tier would trade it
+// for the same tree with scattered nodes.
+template <typename Compare>
+class AdaptiveLadder {
+ public:
+  using price_level = double;
+  using pair_type   = std::pair<price_level, OrderBookLevel>;
+  using flat_map_t  = dro::FlatMap<price_level, OrderBookLevel, uint32_t,
+                                   Compare>;
+
+  enum class Mode : uint8_t { Array, FlatMap };
+
+ private:
+  constexpr static double epsilon                = 1e-9;
+  // Sampling, defaults are starting points to tune against the suite results
+  constexpr static std::size_t SAMPLE_WINDOW     = 4096;
+  constexpr static std::size_t CONFIRM_WINDOWS   = 2;
+  constexpr static std::size_t ARRAY_ENTER_DEPTH = 96;
+  constexpr static std::size_t ARRAY_EXIT_DEPTH  = 192;
+  // The array is never right past this depth, leave without waiting
+  constexpr static std::size_t ARRAY_MAX_DEPTH   = 512;
+
+  Mode mode_{Mode::Array};
+  // Array, prices kept apart from quantities so the scan vectorizes
+  std::vector<price_level> prices_;
+  std::vector<OrderBookLevel> levels_;
+  flat_map_t flat_map_;
+  Compare compare_{};
+
+  // Sampling counters
+  std::size_t updates_{};
+  std::size_t confirmations_{};
+  Mode candidate_{Mode::Array};
+
+  // Levels ordered before price, branchless so it compiles to SIMD compares
+  [[nodiscard]] std::size_t array_position(const price_level& price) const
+  {
+    std::size_t position{};
+    for (const auto& level_price : prices_) {
+      position += static_cast<std::size_t>(compare_(level_price, price));
+    }
+    return position;
+  }
+
+  void array_update(const price_level& price, const double& quantity)
+  {
+    const std::size_t position = array_position(price);
+    const auto offset          = static_cast<std::ptrdiff_t>(position);
+    if (position != prices_.size() && prices_[position] == price) {
+      // Erase
+      if (quantity < epsilon) {
+        prices_.erase(prices_.begin() + offset);
+        levels_.erase(levels_.begin() + offset);
+        return;
+      }
+      // Update
+      levels_[position].quantity_ = quantity;
+      return;
+    }
+    // Insert
+    if (quantity >= epsilon) {
+      prices_.insert(prices_.begin() + offset, price);
+      levels_.insert(levels_.begin() + offset, OrderBookLevel{quantity});
+    }
+  }
+
+  template <typename Map>
+  static void map_update(Map& map, const price_level& price,
+                         const double& quantity)
+  {
+    if (quantity < epsilon) {
+      map.erase(price);
+      return;
+    }
+    map.insert_or_assign(price, OrderBookLevel{quantity});
+  }
+
+  template <typename Function>
+  void for_each_level(Function&& function) const
+  {
+    switch (mode_) {
+    case Mode::Array:
+      for (std::size_t i{}; i < prices_.size(); ++i) {
+        function(prices_[i], levels_[i]);
+      }
+      return;
+    case Mode::FlatMap:
+      for (const auto& level : flat_map_) {
+        function(level.first, level.second);
+      }
+      return;
+    }
+  }
+
+  [[nodiscard]] Mode choose_mode(const std::size_t depth) const
+  {
+    if (mode_ == Mode::Array ? depth <= ARRAY_EXIT_DEPTH
+                             : depth < ARRAY_ENTER_DEPTH)
+    {
+      return Mode::Array;
+    }
+    return Mode::FlatMap;
+  }
+
+  void migrate(const Mode target)
+  {
+    std::vector<pair_type> levels;
+    levels.reserve(size());
+    for_each_level([&levels](const price_level& price,
+                             const OrderBookLevel& level) {
+      levels.emplace_back(price, level);
+    });
+    clear_storage();
+    mode_ = target;
+    // Levels come out in order, appends for every representation
+    for (const auto& level : levels) {
+      insert_ordered(level.first, level.second);
+    }
+  }
+
+  void insert_ordered(const price_level& price, const OrderBookLevel& level)
+  {
+    switch (mode_) {
+    case Mode::Array:
+      prices_.push_back(price);
+      levels_.push_back(level);
+      return;
+    case Mode::FlatMap: flat_map_.emplace(price, level); return;
+    }
+  }
+
+  void sample()
+  {
+    ++updates_;
+    if (mode_ == Mode::Array && prices_.size() > ARRAY_MAX_DEPTH) {
+      migrate(Mode::FlatMap);
+      // A vote already under way was taken in the array
+      candidate_     = Mode::FlatMap;
+      confirmations_ = 0;
+    }
+    if (updates_ < SAMPLE_WINDOW) {
+      return;
+    }
+    const Mode target = choose_mode(size());
+    if (target == mode_) {
+      confirmations_ = 0;
+    } else if (target == candidate_ && ++confirmations_ >= CONFIRM_WINDOWS) {
+      migrate(target);
+      confirmations_ = 0;
+    } else if (target != candidate_) {
+      candidate_     = target;
+      confirmations_ = 1;
+    }
+    updates_ = 0;
+  }
+
+  void clear_storage()
+  {
+    prices_.clear();
+    levels_.clear();
+    flat_map_.clear();
+  }
+
+ public:
+  void update(const price_level& price, const double& quantity)
+  {
+    switch (mode_) {
+    case Mode::Array: array_update(price, quantity); break;
+    case Mode::FlatMap: map_update(flat_map_, price, quantity); break;
+    }
+    sample();
+  }
+
+  // Sweeps aren't sampled, they don't say much about the steady state
+  void erase_through(const price_level& price)
+  {
+    switch (mode_) {
+    case Mode::Array: {
+      std::size_t count{};
+      for (const auto& level_price : prices_) {
+        count += static_cast<std::size_t>(!compare_(price, level_price));
+      }
+      const auto offset = static_cast<std::ptrdiff_t>(count);
+      prices_.erase(prices_.begin(), prices_.begin() + offset);
+      levels_.erase(levels_.begin(), levels_.begin() + offset);
+      return;
+    }
+    case Mode::FlatMap:
+      // dro::FlatMap exposes no range erase, one erase per level
+      while (!flat_map_.empty() && !compare_(price, flat_map_.begin()->first)) {
+        flat_map_.erase(flat_map_.begin());
+      }
+      return;
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const
+  {
+    switch (mode_) {
+    case Mode::Array: return prices_.size();
+    case Mode::FlatMap: return flat_map_.size();
+    }
+    return 0;
+  }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  // Undefined when empty
+  [[nodiscard]] price_level best() const
+  {
+    switch (mode_) {
+    case Mode::Array: return prices_.front();
+    case Mode::FlatMap: return flat_map_.begin()->first;
+    }
+    return {};
+  }
+
+  [[nodiscard]] Mode mode() const { return mode_; }
+
+  void clear()
+  {
+    clear_storage();
+    mode_          = Mode::Array;
+    candidate_     = Mode::Array;
+    confirmations_ = 0;
+    updates_       = 0;
+  }
+};
+
+class AdaptiveOrderbook {
+ public:
+  using price_level   = double;
+  using bid_container = AdaptiveLadder<std::greater<price_level>>;
+  using ask_container = AdaptiveLadder<std::less<price_level>>;
+
+ private:
+  bid_container bid_;
+  ask_container ask_;
+
+ public:
+  AdaptiveOrderbook() = default;
+
+  void build_sides(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    update_book(buy_sell, price, quantity);
+  }
+
+  void update_book(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.update(price, quantity);
+      return;
+    }
+    // Ask ///////////////
+    ask_.update(price, quantity);
+  }
+
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase_through(price);
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase_through(price);
+  }
+
+  void clear_book()
+  {
+    bid_.clear();
+    ask_.clear();
+  }
+
+  [[nodiscard]] bool is_crossed() const
+  {
+    if (ask_.empty() || bid_.empty()) {
+      return false;
+    }
+    return ask_.best() <= bid_.best();
+  }
+};
+}  // namespace gkp
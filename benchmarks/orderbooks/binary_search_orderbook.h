@@ -94,6 +94,27 @@ class BinarySearchOrderbook {
     }
   }
 
+  // Remove every level from the touch through price, a sweep of the book.
+  // Both sides are ascending, the best bid is at the back
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      auto it = std::lower_bound(bid_.begin(), bid_.end(), price,
+                                 [](const pair_type& pair, const double& key) {
+                                   return pair.first < key;
+                                 });
+      bid_.erase(it, bid_.end());
+      return;
+    }
+    // Ask ///////////////
+    auto it = std::upper_bound(ask_.begin(), ask_.end(), price,
+                               [](const double& key, const pair_type& pair) {
+                                 return key < pair.first;
+                               });
+    ask_.erase(ask_.begin(), it);
+  }
+
   void clear_book()
   {
     bid_.clear();
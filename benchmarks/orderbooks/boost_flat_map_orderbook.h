@@ -59,6 +59,19 @@ class BoostFlatMapOrderbook {
     ask_.insert_or_assign(price, OrderBookLevel{quantity});
   }
 
+  // Remove every level from the touch through price, a sweep of the book.
+  // The flat map shifts the tail once for the whole range
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase(bid_.begin(), bid_.upper_bound(price));
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase(ask_.begin(), ask_.upper_bound(price));
+  }
+
   void clear_book()
   {
     bid_.clear();
@@ -86,6 +99,8 @@ struct BoostFlatMapOrderbook {
                    const double& quantity)
   {}
 
+  void erase_through(const char buy_sell, const double& price) {}
+
   void clear_book() {}
 
   [[nodiscard]] bool is_crossed() const { return false; }
@@ -55,6 +55,22 @@ class DroFlatMapOrderbook {
     ask_.insert_or_assign(price, OrderBookLevel{quantity});
   }
 
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      while (!bid_.empty() && bid_.begin()->first >= price) {
+        bid_.erase(bid_.begin());
+      }
+      return;
+    }
+    // Ask ///////////////
+    while (!ask_.empty() && ask_.begin()->first <= price) {
+      ask_.erase(ask_.begin());
+    }
+  }
+
   void clear_book()
   {
     bid_.clear();
@@ -0,0 +1,240 @@
+#pragma once
+// Header Guard
+
+#include "helper/orderbook_level.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace gkp {
+
+// Sorted array with the best price at the front and an empty gap that follows
+// the most recent insert or erase. Elements are only shifted between the gap
+// and the modified position, so activity near the touch costs O(gap distance)
+// instead of O(n). Updates to existing levels never move the gap.
+template <typename Compare>
+class GapBufferLadder {
+ public:
+  using price_level = double;
+  using pair_type   = std::pair<price_level, OrderBookLevel>;
+  using container   = std::vector<pair_type>;
+
+ private:
+  constexpr static double epsilon           = 1e-9;
+  constexpr static std::size_t MIN_GAP_SIZE = 64;
+  container buffer_;
+  // Physical indices, [gap_begin_, gap_end_) holds no levels
+  std::size_t gap_begin_{};
+  std::size_t gap_end_{};
+  Compare compare_{};
+
+  [[nodiscard]] std::size_t gap_size() const { return gap_end_ - gap_begin_; }
+
+  [[nodiscard]] std::size_t to_physical(const std::size_t index) const
+  {
+    return (index < gap_begin_) ? index : index + gap_size();
+  }
+
+  // Logical index of the first level not ordered before price
+  [[nodiscard]] std::size_t lower_bound(const price_level& price) const
+  {
+    auto cmp = [this](const pair_type& pair, const price_level& key) {
+      return compare_(pair.first, key);
+    };
+    const pair_type* data = buffer_.data();
+    // Check the segment in front of the gap first
+    if (gap_begin_ != 0 && !compare_(data[gap_begin_ - 1].first, price)) {
+      return static_cast<std::size_t>(
+          std::lower_bound(data, data + gap_begin_, price, cmp) - data);
+    }
+    const pair_type* back = data + gap_end_;
+    return gap_begin_
+           + static_cast<std::size_t>(
+               std::lower_bound(back, data + buffer_.size(), price, cmp)
+               - back);
+  }
+
+  // Relocate the gap so it starts at logical index
+  void move_gap(const std::size_t index)
+  {
+    pair_type* data = buffer_.data();
+    if (index < gap_begin_) {
+      const std::size_t count = gap_begin_ - index;
+      std::move_backward(data + index, data + gap_begin_, data + gap_end_);
+      gap_begin_ -= count;
+      gap_end_   -= count;
+    } else if (index > gap_begin_) {
+      const std::size_t count = index - gap_begin_;
+      std::move(data + gap_end_, data + gap_end_ + count, data + gap_begin_);
+      gap_begin_ += count;
+      gap_end_   += count;
+    }
+  }
+
+  // Reallocate with a fresh gap opened at logical index
+  void grow(const std::size_t index)
+  {
+    const std::size_t count = size();
+    const std::size_t gap   = std::max(count, MIN_GAP_SIZE);
+    container buffer(count + gap);
+    for (std::size_t i{}; i < index; ++i) {
+      buffer[i] = buffer_[to_physical(i)];
+    }
+    for (std::size_t i{index}; i < count; ++i) {
+      buffer[i + gap] = buffer_[to_physical(i)];
+    }
+    buffer_.swap(buffer);
+    gap_begin_ = index;
+    gap_end_   = index + gap;
+  }
+
+  void insert(const std::size_t index, const price_level& price,
+              const double& quantity)
+  {
+    if (gap_size() == 0) {
+      grow(index);
+    } else {
+      move_gap(index);
+    }
+    buffer_[gap_begin_++] = pair_type{price, OrderBookLevel{quantity}};
+  }
+
+  void erase(const std::size_t index)
+  {
+    // Absorb the level into the gap from whichever side it's on
+    if (index < gap_begin_) {
+      move_gap(index + 1);
+      --gap_begin_;
+      return;
+    }
+    move_gap(index);
+    ++gap_end_;
+  }
+
+ public:
+  void build(const price_level& price, const double& quantity)
+  {
+    update(price, quantity);
+  }
+
+  void update(const price_level& price, const double& quantity)
+  {
+    const std::size_t index = lower_bound(price);
+    if (index != size()) {
+      auto& pair = buffer_[to_physical(index)];
+      if (pair.first == price) {
+        // Erase
+        if (quantity < epsilon) {
+          erase(index);
+          return;
+        }
+        // Update
+        pair.second.quantity_ = quantity;
+        return;
+      }
+    }
+    // Insert
+    if (quantity >= epsilon) {
+      insert(index, price, quantity);
+    }
+  }
+
+  // Levels through price are moved in front of the gap, which then takes
+  // them over without shifting anything else
+  void erase_through(const price_level& price)
+  {
+    std::size_t count = lower_bound(price);
+    if (count != size() && buffer_[to_physical(count)].first == price) {
+      ++count;
+    }
+    move_gap(count);
+    gap_begin_ = 0;
+  }
+
+  // Returns nullptr when the ladder is empty
+  [[nodiscard]] const pair_type* best() const
+  {
+    return empty() ? nullptr : &buffer_[to_physical(0)];
+  }
+
+  [[nodiscard]] std::size_t size() const
+  {
+    return buffer_.size() - gap_size();
+  }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  void clear()
+  {
+    // Keep the allocation, the whole buffer becomes the gap
+    gap_begin_ = 0;
+    gap_end_   = buffer_.size();
+  }
+};
+
+class GapBufferOrderbook {
+ public:
+  using price_level   = double;
+  using bid_container = GapBufferLadder<std::greater<price_level>>;
+  using ask_container = GapBufferLadder<std::less<price_level>>;
+
+ private:
+  bid_container bid_;
+  ask_container ask_;
+
+ public:
+  GapBufferOrderbook() = default;
+
+  void build_sides(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    if (buy_sell == 'b') {
+      bid_.build(price, quantity);
+      return;
+    }
+    ask_.build(price, quantity);
+  }
+
+  void update_book(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.update(price, quantity);
+      return;
+    }
+    // Ask ///////////////
+    ask_.update(price, quantity);
+  }
+
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase_through(price);
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase_through(price);
+  }
+
+  void clear_book()
+  {
+    bid_.clear();
+    ask_.clear();
+  }
+
+  [[nodiscard]] bool is_crossed() const
+  {
+    if (ask_.empty() || bid_.empty()) {
+      return false;
+    }
+    return ask_.best()->first <= bid_.best()->first;
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,166 @@
+#pragma once
+// Header Guard
+
+#include "../../submodules/unordered_dense/include/ankerl/unordered_dense.h"
+#include "helper/orderbook_level.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace gkp {
+
+// Levels live in a hashmap, the best price is tracked by a binary heap with
+// lazy deletion. Erased prices stay in the heap until they reach the top, so
+// the heap is only touched on a new price or when the touch is erased.
+// HeapCompare follows std::push_heap, std::less gives the max price on top.
+template <typename HeapCompare>
+class HeapHashLadder {
+ public:
+  using price_level = double;
+  using hashmap_t   = ankerl::unordered_dense::map<price_level, OrderBookLevel>;
+  using heap_t      = std::vector<price_level>;
+
+ private:
+  constexpr static double epsilon            = 1e-9;
+  // Rebuild once stale prices outnumber live ones by this factor
+  constexpr static std::size_t REBUILD_RATIO = 2;
+  constexpr static std::size_t MIN_HEAP_SIZE = 64;
+  hashmap_t levels_;
+  heap_t heap_;
+  HeapCompare compare_{};
+
+  // Pop erased prices until the top is a live level
+  void prune_top()
+  {
+    while (!heap_.empty() && !levels_.contains(heap_.front())) {
+      std::pop_heap(heap_.begin(), heap_.end(), compare_);
+      heap_.pop_back();
+    }
+  }
+
+  void push(const price_level& price)
+  {
+    if (heap_.size() >= MIN_HEAP_SIZE
+        && heap_.size() >= REBUILD_RATIO * levels_.size())
+    {
+      // Too many stale entries, rebuild from the live levels
+      heap_.clear();
+      for (const auto& level : levels_) {
+        heap_.push_back(level.first);
+      }
+      std::make_heap(heap_.begin(), heap_.end(), compare_);
+      return;
+    }
+    heap_.push_back(price);
+    std::push_heap(heap_.begin(), heap_.end(), compare_);
+  }
+
+ public:
+  void update(const price_level& price, const double& quantity)
+  {
+    // Erase
+    if (quantity < epsilon) {
+      if (levels_.erase(price) != 0 && heap_.front() == price) {
+        prune_top();
+      }
+      return;
+    }
+    // Update, single hash probe
+    auto [it, inserted] = levels_.try_emplace(price, quantity);
+    if (!inserted) {
+      it->second.quantity_ = quantity;
+      return;
+    }
+    // Insert
+    push(price);
+  }
+
+  // Pop from the top while it's at or better than price
+  void erase_through(const price_level& price)
+  {
+    while (!heap_.empty() && !compare_(heap_.front(), price)) {
+      levels_.erase(heap_.front());
+      std::pop_heap(heap_.begin(), heap_.end(), compare_);
+      heap_.pop_back();
+    }
+    prune_top();
+  }
+
+  [[nodiscard]] bool empty() const { return levels_.empty(); }
+
+  // Undefined when empty
+  [[nodiscard]] price_level best() const { return heap_.front(); }
+
+  void clear()
+  {
+    levels_.clear();
+    heap_.clear();
+  }
+};
+
+class HeapAnkerlOrderbook {
+ public:
+  using price_level   = double;
+  using bid_container = HeapHashLadder<std::less<price_level>>;
+  using ask_container = HeapHashLadder<std::greater<price_level>>;
+
+ private:
+  bid_container bid_;
+  ask_container ask_;
+
+ public:
+  HeapAnkerlOrderbook() = default;
+
+  void build_sides(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    if (buy_sell == 'b') {
+      bid_.update(price, quantity);
+      return;
+    }
+    ask_.update(price, quantity);
+  }
+
+  void update_book(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.update(price, quantity);
+      return;
+    }
+    // Ask ///////////////
+    ask_.update(price, quantity);
+  }
+
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase_through(price);
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase_through(price);
+  }
+
+  void clear_book()
+  {
+    bid_.clear();
+    ask_.clear();
+  }
+
+  [[nodiscard]] bool is_crossed() const
+  {
+    if (ask_.empty() || bid_.empty()) {
+      return false;
+    }
+    return ask_.best() <= bid_.best();
+  }
+};
+}  // namespace gkp
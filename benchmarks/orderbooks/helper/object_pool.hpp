@@ -0,0 +1,73 @@
+#pragma once
+
+// Header Guard
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gkp {
+
+// Index addressed pool, nodes link to each other by index so growing the
+// storage never invalidates a link. Released slots are reused last in first
+// out, the most recently freed node is the one most likely still in cache.
+template <typename T>
+class ObjectPool {
+ public:
+  using index_type = uint32_t;
+
+  constexpr static index_type NULL_INDEX = ~index_type{};
+
+ private:
+  std::vector<T> storage_;
+  std::vector<index_type> free_;
+
+ public:
+  ObjectPool() = default;
+
+  explicit ObjectPool(const std::size_t capacity)
+  {
+    storage_.reserve(capacity);
+    free_.reserve(capacity);
+  }
+
+  [[nodiscard]] index_type allocate()
+  {
+    if (!free_.empty()) {
+      const index_type index = free_.back();
+      free_.pop_back();
+      return index;
+    }
+    storage_.emplace_back();
+    return static_cast<index_type>(storage_.size() - 1);
+  }
+
+  void release(const index_type index) { free_.push_back(index); }
+
+  [[nodiscard]] T& operator[](const index_type index)
+  {
+    return storage_[index];
+  }
+
+  [[nodiscard]] const T& operator[](const index_type index) const
+  {
+    return storage_[index];
+  }
+
+  // Nodes in use
+  [[nodiscard]] std::size_t size() const
+  {
+    return storage_.size() - free_.size();
+  }
+
+  // Keeps the storage, every node becomes free
+  void clear()
+  {
+    free_.clear();
+    for (std::size_t i = storage_.size(); i > 0; --i) {
+      free_.push_back(static_cast<index_type>(i - 1));
+    }
+  }
+};
+
+}  // namespace gkp
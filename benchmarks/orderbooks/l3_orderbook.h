@@ -0,0 +1,308 @@
+#pragma once
+// Header Guard
+
+#include "../../submodules/Flat-Map-RB-Tree/include/dro/flat-rb-tree.hpp"
+#include "../../submodules/unordered_dense/include/ankerl/unordered_dense.h"
+#include "helper/object_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+
+namespace gkp {
+
+struct L3Order {
+  uint64_t id_{};
+  double quantity_{};
+  uint32_t level_{};
+  // Intrusive FIFO links inside the level
+  uint32_t prev_{};
+  uint32_t next_{};
+  bool is_bid_{};
+};
+
+// Resting order hit by an execution
+struct L3Execution {
+  uint64_t id_{};
+  double quantity_{};
+};
+
+struct L3Level {
+  double price_{};
+  // Sum of the resting quantity, the L2 view of the level
+  double quantity_{};
+  uint32_t head_{};
+  uint32_t tail_{};
+  uint32_t count_{};
+};
+
+// Order by order book. Each price level is an intrusive doubly linked FIFO of
+// orders in time priority and an order id map gives O(1) cancel, modify and
+// execute. Orders and levels come from index pools, the price containers only
+// map a price to its level node, so any of the benchmarked L2 containers can
+// be plugged in through BidMap and AskMap.
+template <typename BidMap, typename AskMap>
+class L3Orderbook {
+ public:
+  using price_level   = double;
+  using order_id      = uint64_t;
+  using bid_container = BidMap;
+  using ask_container = AskMap;
+  using order_pool    = ObjectPool<L3Order>;
+  using level_pool    = ObjectPool<L3Level>;
+  using order_map     = ankerl::unordered_dense::map<order_id, uint32_t>;
+  using index_type    = typename order_pool::index_type;
+
+  constexpr static index_type NULL_INDEX = order_pool::NULL_INDEX;
+
+ private:
+  constexpr static double epsilon = 1e-9;
+  bid_container bid_;
+  ask_container ask_;
+  order_pool orders_;
+  level_pool levels_;
+  order_map order_index_;
+
+  template <typename Map>
+  index_type find_or_add_level(Map& side, const price_level& price)
+  {
+    const auto it = side.find(price);
+    if (it != side.end()) {
+      return it->second;
+    }
+    const index_type level = levels_.allocate();
+    levels_[level]         = L3Level{price, 0.0, NULL_INDEX, NULL_INDEX, 0};
+    side.emplace(price, level);
+    return level;
+  }
+
+  // Link at the tail, last in time priority
+  void push_back(const index_type level_index, const index_type order_index)
+  {
+    L3Level& level = levels_[level_index];
+    L3Order& order = orders_[order_index];
+    order.level_   = level_index;
+    order.prev_    = level.tail_;
+    order.next_    = NULL_INDEX;
+    if (level.tail_ == NULL_INDEX) {
+      level.head_ = order_index;
+    } else {
+      orders_[level.tail_].next_ = order_index;
+    }
+    level.tail_ = order_index;
+    ++level.count_;
+    level.quantity_ += order.quantity_;
+  }
+
+  // Unlink the order and drop the level once its queue is empty
+  void unlink(const index_type order_index)
+  {
+    const L3Order& order = orders_[order_index];
+    L3Level& level       = levels_[order.level_];
+    if (order.prev_ == NULL_INDEX) {
+      level.head_ = order.next_;
+    } else {
+      orders_[order.prev_].next_ = order.next_;
+    }
+    if (order.next_ == NULL_INDEX) {
+      level.tail_ = order.prev_;
+    } else {
+      orders_[order.next_].prev_ = order.prev_;
+    }
+    level.quantity_ -= order.quantity_;
+    if (--level.count_ != 0) {
+      return;
+    }
+    if (order.is_bid_) {
+      bid_.erase(level.price_);
+    } else {
+      ask_.erase(level.price_);
+    }
+    levels_.release(order.level_);
+  }
+
+  void remove(const typename order_map::iterator it)
+  {
+    unlink(it->second);
+    orders_.release(it->second);
+    order_index_.erase(it);
+  }
+
+ public:
+  L3Orderbook() = default;
+
+  // Pools are preallocated for capacity resting orders
+  explicit L3Orderbook(const std::size_t capacity)
+      : orders_(capacity), levels_(capacity)
+  {
+    order_index_.reserve(capacity);
+  }
+
+  // Returns false for a duplicate id or an empty order
+  bool add_order(const order_id id, const char buy_sell,
+                 const price_level& price, const double& quantity)
+  {
+    if (quantity < epsilon) {
+      return false;
+    }
+    const auto [it, inserted] = order_index_.try_emplace(id, 0);
+    if (!inserted) {
+      return false;
+    }
+    const bool is_bid      = (buy_sell == 'b');
+    const index_type order = orders_.allocate();
+    orders_[order]         = L3Order{id, quantity, 0, NULL_INDEX, NULL_INDEX,
+                                     is_bid};
+    it->second             = order;
+    // Bid ///////////////
+    if (is_bid) {
+      push_back(find_or_add_level(bid_, price), order);
+      return true;
+    }
+    // Ask ///////////////
+    push_back(find_or_add_level(ask_, price), order);
+    return true;
+  }
+
+  // Returns false for an unknown id
+  bool cancel_order(const order_id id)
+  {
+    const auto it = order_index_.find(id);
+    if (it == order_index_.end()) {
+      return false;
+    }
+    remove(it);
+    return true;
+  }
+
+  // A smaller quantity at the same price keeps time priority, anything else
+  // goes to the back of the queue at the new price
+  bool modify_order(const order_id id, const price_level& price,
+                    const double& quantity)
+  {
+    const auto it = order_index_.find(id);
+    if (it == order_index_.end()) {
+      return false;
+    }
+    L3Order& order = orders_[it->second];
+    L3Level& level = levels_[order.level_];
+    if (quantity < epsilon) {
+      remove(it);
+      return true;
+    }
+    if (level.price_ == price && quantity <= order.quantity_) {
+      level.quantity_ -= order.quantity_ - quantity;
+      order.quantity_  = quantity;
+      return true;
+    }
+    const bool is_bid      = order.is_bid_;
+    const index_type index = it->second;
+    unlink(index);
+    orders_[index].quantity_ = quantity;
+    if (is_bid) {
+      push_back(find_or_add_level(bid_, price), index);
+    } else {
+      push_back(find_or_add_level(ask_, price), index);
+    }
+    return true;
+  }
+
+  // Fill against a resting order, returns the quantity executed
+  double execute_order(const order_id id, const double& quantity)
+  {
+    const auto it = order_index_.find(id);
+    if (it == order_index_.end()) {
+      return 0.0;
+    }
+    L3Order& order = orders_[it->second];
+    if (quantity < order.quantity_ - epsilon) {
+      order.quantity_                 -= quantity;
+      levels_[order.level_].quantity_ -= quantity;
+      return quantity;
+    }
+    const double filled = order.quantity_;
+    remove(it);
+    return filled;
+  }
+
+  // Fill against the oldest order at the touch, undefined when the side is
+  // empty. Saves the id lookup when matching walks the queue
+  L3Execution execute_front(const char buy_sell, const double& quantity)
+  {
+    const index_type level = (buy_sell == 'b') ? bid_.begin()->second
+                                               : ask_.begin()->second;
+    const index_type index = levels_[level].head_;
+    L3Order& order         = orders_[index];
+    if (quantity < order.quantity_ - epsilon) {
+      order.quantity_          -= quantity;
+      levels_[level].quantity_ -= quantity;
+      return L3Execution{order.id_, quantity};
+    }
+    const L3Execution execution{order.id_, order.quantity_};
+    unlink(index);
+    orders_.release(index);
+    order_index_.erase(execution.id_);
+    return execution;
+  }
+
+  // Oldest order at the touch, undefined when the side is empty
+  [[nodiscard]] order_id front_order(const char buy_sell) const
+  {
+    const index_type level = (buy_sell == 'b') ? bid_.begin()->second
+                                               : ask_.begin()->second;
+    return orders_[levels_[level].head_].id_;
+  }
+
+  [[nodiscard]] bool has_orders(const char buy_sell) const
+  {
+    return (buy_sell == 'b') ? !bid_.empty() : !ask_.empty();
+  }
+
+  // Undefined when the side is empty
+  [[nodiscard]] price_level best_price(const char buy_sell) const
+  {
+    return (buy_sell == 'b') ? bid_.begin()->first : ask_.begin()->first;
+  }
+
+  // Aggregate quantity at the touch, undefined when the side is empty
+  [[nodiscard]] double best_quantity(const char buy_sell) const
+  {
+    const index_type level = (buy_sell == 'b') ? bid_.begin()->second
+                                               : ask_.begin()->second;
+    return levels_[level].quantity_;
+  }
+
+  [[nodiscard]] std::size_t order_count() const { return order_index_.size(); }
+
+  [[nodiscard]] std::size_t level_count() const
+  {
+    return bid_.size() + ask_.size();
+  }
+
+  void clear_book()
+  {
+    bid_.clear();
+    ask_.clear();
+    orders_.clear();
+    levels_.clear();
+    order_index_.clear();
+  }
+
+  [[nodiscard]] bool is_crossed() const
+  {
+    if (ask_.empty() || bid_.empty()) {
+      return false;
+    }
+    return ask_.begin()->first <= bid_.begin()->first;
+  }
+};
+
+using DroFlatMapL3Orderbook =
+    L3Orderbook<dro::FlatMap<double, uint32_t, uint32_t, std::greater<double>>,
+                dro::FlatMap<double, uint32_t, uint32_t, std::less<double>>>;
+
+using stdMapL3Orderbook =
+    L3Orderbook<std::map<double, uint32_t, std::greater<double>>,
+                std::map<double, uint32_t, std::less<double>>>;
+}  // namespace gkp
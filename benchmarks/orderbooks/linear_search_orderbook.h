@@ -75,6 +75,23 @@ class LinearSearchOrderbook {
     }
   }
 
+  // Remove every level from the touch through price, a sweep of the book.
+  // The levels are unordered, one pass compacts the whole side
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      std::erase_if(bid_, [&price](const pair_type& pair) {
+        return pair.first >= price;
+      });
+      return;
+    }
+    // Ask ///////////////
+    std::erase_if(ask_, [&price](const pair_type& pair) {
+      return pair.first <= price;
+    });
+  }
+
   void clear_book()
   {
     bid_.clear();
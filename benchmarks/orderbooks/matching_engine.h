@@ -0,0 +1,85 @@
+#pragma once
+// Header Guard
+
+#include "l3_orderbook.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gkp {
+
+enum class OrderType : uint8_t {
+  Limit,
+  Market,
+  // Matches what it can at the limit price, the rest is cancelled
+  ImmediateOrCancel
+};
+
+struct Fill {
+  uint64_t taker_id_{};
+  uint64_t maker_id_{};
+  double price_{};
+  double quantity_{};
+};
+
+// Price time priority matching over an L3 book. An incoming order walks the
+// contra side from the touch, filling the oldest order of each level first
+// at the resting price. Whatever is left of a limit order rests, market and
+// IOC remainders are dropped. Generic over the L3Orderbook price containers.
+template <typename Orderbook>
+class MatchingEngine {
+ public:
+  using price_level = typename Orderbook::price_level;
+  using order_id    = typename Orderbook::order_id;
+
+ private:
+  constexpr static double epsilon = 1e-9;
+  Orderbook book_;
+  // Fills of the last submit, the storage is reused between orders
+  std::vector<Fill> fills_;
+
+  [[nodiscard]] static bool crosses(const char buy_sell,
+                                    const price_level& limit,
+                                    const price_level& resting)
+  {
+    return (buy_sell == 'b') ? resting <= limit : resting >= limit;
+  }
+
+ public:
+  MatchingEngine() = default;
+
+  explicit MatchingEngine(const std::size_t capacity) : book_(capacity) {}
+
+  // Returns the quantity filled, price is ignored for market orders
+  double submit(const order_id id, const char buy_sell, const OrderType type,
+                const price_level& price, const double& quantity)
+  {
+    fills_.clear();
+    const char contra = (buy_sell == 'b') ? 's' : 'b';
+    double remaining  = quantity;
+    while (remaining >= epsilon && book_.has_orders(contra)) {
+      const price_level resting = book_.best_price(contra);
+      if (type != OrderType::Market && !crosses(buy_sell, price, resting)) {
+        break;
+      }
+      const L3Execution execution = book_.execute_front(contra, remaining);
+      fills_.push_back(
+          Fill{id, execution.id_, resting, execution.quantity_});
+      remaining -= execution.quantity_;
+    }
+    if (type == OrderType::Limit && remaining >= epsilon) {
+      book_.add_order(id, buy_sell, price, remaining);
+    }
+    return quantity - remaining;
+  }
+
+  bool cancel(const order_id id) { return book_.cancel_order(id); }
+
+  [[nodiscard]] const std::vector<Fill>& fills() const { return fills_; }
+
+  [[nodiscard]] const Orderbook& book() const { return book_; }
+
+  void clear_book() { book_.clear_book(); }
+};
+}  // namespace gkp
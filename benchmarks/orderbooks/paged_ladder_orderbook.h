@@ -0,0 +1,247 @@
+#pragma once
+// Header Guard
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gkp {
+
+// Sparse tick ladder, a page directory of fixed size tick pages. Pages are
+// allocated from a pool when the first level lands in them and returned once
+// empty, so a wide price range only costs memory where there is liquidity
+// while keeping O(1) direct indexing.
+template <bool IsBid>
+class PagedLadder {
+ public:
+  using tick_type = int64_t;
+
+  constexpr static std::size_t PAGE_BITS = 8;
+  constexpr static std::size_t PAGE_SIZE = std::size_t{1} << PAGE_BITS;
+
+ private:
+  constexpr static double epsilon              = 1e-9;
+  constexpr static uint32_t NO_PAGE            = ~uint32_t{};
+  constexpr static tick_type OFFSET_MASK       = PAGE_SIZE - 1;
+  // Directory slack added when it grows, avoids regrowing on every new page
+  constexpr static std::size_t DIRECTORY_SLACK = 16;
+
+  struct Page {
+    std::array<double, PAGE_SIZE> quantity_{};
+    std::size_t count_{};
+  };
+
+  std::vector<Page> pool_;
+  std::vector<uint32_t> free_pages_;
+  std::vector<uint32_t> directory_;
+  tick_type base_page_{};
+  tick_type best_{};
+  std::size_t size_{};
+
+  [[nodiscard]] constexpr static bool is_better(const tick_type lhs,
+                                                const tick_type rhs)
+  {
+    return IsBid ? lhs > rhs : lhs < rhs;
+  }
+
+  [[nodiscard]] Page* find_page(const tick_type page)
+  {
+    const tick_type index = page - base_page_;
+    if (index < 0 || index >= static_cast<tick_type>(directory_.size())) {
+      return nullptr;
+    }
+    const uint32_t slot = directory_[static_cast<std::size_t>(index)];
+    return (slot == NO_PAGE) ? nullptr : &pool_[slot];
+  }
+
+  // Directory slot for page, growing the directory in either direction
+  uint32_t& directory_slot(const tick_type page)
+  {
+    if (directory_.empty()) {
+      base_page_ = page;
+    }
+    if (page < base_page_) {
+      const auto grow = static_cast<std::size_t>(base_page_ - page)
+                        + DIRECTORY_SLACK;
+      directory_.insert(directory_.begin(), grow, NO_PAGE);
+      base_page_ -= static_cast<tick_type>(grow);
+    }
+    const auto index = static_cast<std::size_t>(page - base_page_);
+    if (index >= directory_.size()) {
+      directory_.resize(index + DIRECTORY_SLACK, NO_PAGE);
+    }
+    return directory_[index];
+  }
+
+  uint32_t allocate_page()
+  {
+    if (!free_pages_.empty()) {
+      const uint32_t slot = free_pages_.back();
+      free_pages_.pop_back();
+      return slot;
+    }
+    pool_.emplace_back();
+    return static_cast<uint32_t>(pool_.size() - 1);
+  }
+
+  // Walk away from the touch to the next live level, pages in the directory
+  // always hold at least one level
+  void find_next_best(const tick_type from)
+  {
+    tick_type page_num = from >> PAGE_BITS;
+    auto offset        = static_cast<std::size_t>(from & OFFSET_MASK);
+    const tick_type last_page =
+        base_page_ + static_cast<tick_type>(directory_.size()) - 1;
+    for (; page_num >= base_page_ && page_num <= last_page;
+         page_num += IsBid ? -1 : 1, offset = IsBid ? PAGE_SIZE - 1 : 0)
+    {
+      const Page* page = find_page(page_num);
+      if (page == nullptr) {
+        continue;
+      }
+      // Bids count down, the unsigned wrap past zero ends the loop
+      for (std::size_t i = offset; i < PAGE_SIZE; IsBid ? --i : ++i) {
+        if (page->quantity_[i] >= epsilon) {
+          best_ = (page_num << PAGE_BITS) + static_cast<tick_type>(i);
+          return;
+        }
+      }
+    }
+  }
+
+ public:
+  void update(const tick_type tick, const double& quantity)
+  {
+    const tick_type page_num = tick >> PAGE_BITS;
+    const auto offset        = static_cast<std::size_t>(tick & OFFSET_MASK);
+    Page* page               = find_page(page_num);
+    // Erase
+    if (quantity < epsilon) {
+      if (page == nullptr || page->quantity_[offset] < epsilon) {
+        return;
+      }
+      page->quantity_[offset] = 0.0;
+      --size_;
+      if (--page->count_ == 0) {
+        uint32_t& slot = directory_slot(page_num);
+        free_pages_.push_back(slot);
+        slot = NO_PAGE;
+      }
+      if (size_ != 0 && tick == best_) {
+        find_next_best(tick);
+      }
+      return;
+    }
+    // Insert
+    if (page == nullptr) {
+      const uint32_t slot      = allocate_page();
+      directory_slot(page_num) = slot;
+      page                     = &pool_[slot];
+    }
+    if (page->quantity_[offset] < epsilon) {
+      ++page->count_;
+      if (size_++ == 0 || is_better(tick, best_)) {
+        best_ = tick;
+      }
+    }
+    // Update
+    page->quantity_[offset] = quantity;
+  }
+
+  void erase_through(const tick_type tick)
+  {
+    while (size_ != 0 && !is_better(tick, best_)) {
+      update(best_, 0.0);
+    }
+  }
+
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  [[nodiscard]] std::size_t size() const { return size_; }
+
+  // Undefined when empty
+  [[nodiscard]] tick_type best() const { return best_; }
+
+  void clear()
+  {
+    // Keep the pool, every page goes back on the free list
+    free_pages_.clear();
+    for (std::size_t i{}; i < pool_.size(); ++i) {
+      pool_[i] = Page{};
+      free_pages_.push_back(static_cast<uint32_t>(i));
+    }
+    directory_.clear();
+    size_ = 0;
+  }
+};
+
+class PagedLadderOrderbook {
+ public:
+  using price_level   = double;
+  using bid_container = PagedLadder<true>;
+  using ask_container = PagedLadder<false>;
+
+ private:
+  bid_container bid_;
+  ask_container ask_;
+  double ticks_per_price_{1.0};
+
+  [[nodiscard]] int64_t to_tick(const double& price) const
+  {
+    return std::llround(price * ticks_per_price_);
+  }
+
+ public:
+  PagedLadderOrderbook() = default;
+
+  explicit PagedLadderOrderbook(const double tick_size)
+      : ticks_per_price_(1.0 / tick_size)
+  {}
+
+  void build_sides(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    update_book(buy_sell, price, quantity);
+  }
+
+  void update_book(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.update(to_tick(price), quantity);
+      return;
+    }
+    // Ask ///////////////
+    ask_.update(to_tick(price), quantity);
+  }
+
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase_through(to_tick(price));
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase_through(to_tick(price));
+  }
+
+  void clear_book()
+  {
+    bid_.clear();
+    ask_.clear();
+  }
+
+  [[nodiscard]] bool is_crossed() const
+  {
+    if (ask_.empty() || bid_.empty()) {
+      return false;
+    }
+    return ask_.best() <= bid_.best();
+  }
+};
+}  // namespace gkp
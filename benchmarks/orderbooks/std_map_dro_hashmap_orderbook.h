@@ -82,6 +82,26 @@ class stdMapDroOrderbook {
     ask_iterators_.emplace(price, it);
   }
 
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      auto last = bid_.upper_bound(price);
+      for (auto it = bid_.begin(); it != last; ++it) {
+        bid_iterators_.erase(it->first);
+      }
+      bid_.erase(bid_.begin(), last);
+      return;
+    }
+    // Ask ///////////////
+    auto last = ask_.upper_bound(price);
+    for (auto it = ask_.begin(); it != last; ++it) {
+      ask_iterators_.erase(it->first);
+    }
+    ask_.erase(ask_.begin(), last);
+  }
+
   void clear_book()
   {
     bid_.clear();
@@ -55,6 +55,18 @@ class stdMapOrderbook {
     ask_.insert_or_assign(price, OrderBookLevel{quantity});
   }
 
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase(bid_.begin(), bid_.upper_bound(price));
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase(ask_.begin(), ask_.upper_bound(price));
+  }
+
   void clear_book()
   {
     bid_.clear();
@@ -0,0 +1,230 @@
+#pragma once
+// Header Guard
+
+#include "helper/orderbook_level.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace gkp {
+
+// Sorted array with the best price at the front. Erased levels are kept in
+// place as tombstones (zero quantity) so an erase never shifts the tail, and a
+// price that reappears revives its tombstone instead of re-inserting. The
+// array is compacted in one pass once tombstones pass COMPACT_RATIO. The
+// index of the first live level is kept up to date, so best() never scans the
+// tombstones left at the touch.
+template <typename Compare>
+class TombstoneLadder {
+ public:
+  using price_level = double;
+  using pair_type   = std::pair<price_level, OrderBookLevel>;
+  using container   = std::vector<pair_type>;
+
+ private:
+  constexpr static double epsilon = 1e-9;
+  // Compact when 1 / COMPACT_RATIO of the slots are tombstones
+  constexpr static std::size_t COMPACT_RATIO = 4;
+  // Small ladders are never compacted, the shift is cheaper than the pass
+  constexpr static std::size_t MIN_COMPACT_SIZE = 64;
+  container levels_;
+  std::size_t tombstones_{};
+  // Every slot before front_ is a tombstone, levels_.size() when none is live
+  std::size_t front_{};
+  Compare compare_{};
+
+  [[nodiscard]] static bool is_tombstone(const pair_type& pair)
+  {
+    return pair.second.quantity_ < epsilon;
+  }
+
+  void maybe_compact()
+  {
+    if (levels_.size() < MIN_COMPACT_SIZE
+        || tombstones_ * COMPACT_RATIO < levels_.size())
+    {
+      return;
+    }
+    std::erase_if(levels_, is_tombstone);
+    tombstones_ = 0;
+    front_      = 0;
+  }
+
+  void skip_tombstones()
+  {
+    while (front_ < levels_.size() && is_tombstone(levels_[front_])) {
+      ++front_;
+    }
+  }
+
+  // A live level now sits at index
+  void mark_live(const std::size_t index)
+  {
+    front_ = std::min(front_, index);
+  }
+
+ public:
+  void build(const price_level& price, const double& quantity)
+  {
+    // Snapshots arrive best price first, append when already in order
+    if (levels_.empty() || compare_(levels_.back().first, price)) {
+      levels_.emplace_back(price, OrderBookLevel{quantity});
+      mark_live(levels_.size() - 1);
+      return;
+    }
+    update(price, quantity);
+  }
+
+  void update(const price_level& price, const double& quantity)
+  {
+    auto it = std::lower_bound(levels_.begin(), levels_.end(), price,
+                               [this](const pair_type& pair,
+                                      const price_level& key) {
+                                 return compare_(pair.first, key);
+                               });
+    const auto index = static_cast<std::size_t>(it - levels_.begin());
+    if (it != levels_.end() && it->first == price) {
+      // Erase
+      if (quantity < epsilon) {
+        if (!is_tombstone(*it)) {
+          it->second.quantity_ = 0.0;
+          ++tombstones_;
+          skip_tombstones();
+          maybe_compact();
+        }
+        return;
+      }
+      // Revive or Update
+      if (is_tombstone(*it)) {
+        --tombstones_;
+        mark_live(index);
+      }
+      it->second.quantity_ = quantity;
+      return;
+    }
+    if (quantity < epsilon) {
+      return;
+    }
+    // Insert, reusing a neighbouring tombstone keeps the order intact
+    if (it != levels_.end() && is_tombstone(*it)) {
+      *it = pair_type{price, OrderBookLevel{quantity}};
+      --tombstones_;
+      mark_live(index);
+      return;
+    }
+    if (it != levels_.begin() && is_tombstone(*std::prev(it))) {
+      *std::prev(it) = pair_type{price, OrderBookLevel{quantity}};
+      --tombstones_;
+      mark_live(index - 1);
+      return;
+    }
+    // Only slots from index on shift, and they're past front_ unless the new
+    // level becomes the front
+    levels_.emplace(it, price, OrderBookLevel{quantity});
+    mark_live(index);
+  }
+
+  // Tombstone every level from the touch through price, nothing shifts
+  void erase_through(const price_level& price)
+  {
+    for (; front_ < levels_.size() && !compare_(price, levels_[front_].first);
+         ++front_)
+    {
+      if (!is_tombstone(levels_[front_])) {
+        levels_[front_].second.quantity_ = 0.0;
+        ++tombstones_;
+      }
+    }
+    skip_tombstones();
+    maybe_compact();
+  }
+
+  // Returns nullptr when the ladder holds no live levels
+  [[nodiscard]] const pair_type* best() const
+  {
+    return (front_ < levels_.size()) ? &levels_[front_] : nullptr;
+  }
+
+  [[nodiscard]] std::size_t size() const
+  {
+    return levels_.size() - tombstones_;
+  }
+
+  [[nodiscard]] std::size_t tombstones() const { return tombstones_; }
+
+  void clear()
+  {
+    levels_.clear();
+    tombstones_ = 0;
+    front_      = 0;
+  }
+};
+
+class TombstoneOrderbook {
+ public:
+  using price_level   = double;
+  using bid_container = TombstoneLadder<std::greater<price_level>>;
+  using ask_container = TombstoneLadder<std::less<price_level>>;
+
+ private:
+  bid_container bid_;
+  ask_container ask_;
+
+ public:
+  TombstoneOrderbook() = default;
+
+  void build_sides(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    if (buy_sell == 'b') {
+      bid_.build(price, quantity);
+      return;
+    }
+    ask_.build(price, quantity);
+  }
+
+  void update_book(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.update(price, quantity);
+      return;
+    }
+    // Ask ///////////////
+    ask_.update(price, quantity);
+  }
+
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase_through(price);
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase_through(price);
+  }
+
+  void clear_book()
+  {
+    bid_.clear();
+    ask_.clear();
+  }
+
+  [[nodiscard]] bool is_crossed() const
+  {
+    const auto* best_bid = bid_.best();
+    const auto* best_ask = ask_.best();
+    if (best_bid == nullptr || best_ask == nullptr) {
+      return false;
+    }
+    return best_ask->first <= best_bid->first;
+  }
+};
+}  // namespace gkp
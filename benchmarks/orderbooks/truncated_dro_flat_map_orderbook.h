@@ -0,0 +1,200 @@
+#pragma once
+// Header Guard
+
+#include "../../submodules/Flat-Map-RB-Tree/include/dro/flat-rb-tree.hpp"
+#include "helper/orderbook_level.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+namespace gkp {
+
+// Flat map side that only retains the top Depth levels. Changes behind the
+// deepest retained level are dropped, and an insert that pushes the side past
+// Depth evicts the worst level. Once anything has been dropped the side
+// remembers its deepest retained price, the exchange's levels beyond it are
+// unknown and stay dropped even after erases free room.
+template <std::size_t Depth, typename Compare>
+class TruncatedLadder {
+ public:
+  using price_level = double;
+  using container =
+      dro::FlatMap<price_level, OrderBookLevel, uint32_t, Compare>;
+
+  // Levels a consumer reads from the top, as the feed handler's published
+  // top
+  constexpr static std::size_t read_depth{Depth < 10 ? Depth : 10};
+
+ private:
+  constexpr static double epsilon = 1e-9;
+  container levels_;
+  price_level boundary_{};
+  std::size_t dropped_{};
+  bool truncated_{};
+  Compare compare_{};
+
+  [[nodiscard]] bool drop_beyond_depth(const price_level& price)
+  {
+    if (!truncated_) {
+      if (levels_.size() < Depth
+          || !compare_(std::prev(levels_.end())->first, price))
+      {
+        return false;
+      }
+      truncated_ = true;
+      boundary_  = std::prev(levels_.end())->first;
+    } else if (!compare_(boundary_, price)) {
+      return false;
+    }
+    ++dropped_;
+    return true;
+  }
+
+  void trim_to_depth()
+  {
+    if (levels_.size() <= Depth) {
+      return;
+    }
+    levels_.erase(std::prev(levels_.end()));
+    truncated_ = true;
+    boundary_  = std::prev(levels_.end())->first;
+  }
+
+ public:
+  void build(const price_level& price, const double& quantity)
+  {
+    if (!drop_beyond_depth(price)) {
+      levels_.emplace(price, OrderBookLevel{quantity});
+      trim_to_depth();
+    }
+  }
+
+  void update(const price_level& price, const double& quantity)
+  {
+    if (drop_beyond_depth(price)) {
+      return;
+    }
+    // Erase
+    if (quantity < epsilon) {
+      const auto it = levels_.find(price);
+      if (it != levels_.end()) {
+        levels_.erase(it);
+      }
+      return;
+    }
+    // Insert or update, evicting the worst level past Depth
+    levels_.insert_or_assign(price, OrderBookLevel{quantity});
+    trim_to_depth();
+  }
+
+  void erase_through(const price_level& price)
+  {
+    while (!levels_.empty() && !compare_(price, levels_.begin()->first)) {
+      levels_.erase(levels_.begin());
+    }
+  }
+
+  // True once a truncated side holds fewer known levels than a consumer
+  // reads
+  [[nodiscard]] bool needs_resnapshot() const
+  {
+    return truncated_ && levels_.size() < read_depth;
+  }
+
+  [[nodiscard]] std::size_t dropped() const { return dropped_; }
+
+  [[nodiscard]] std::size_t size() const { return levels_.size(); }
+
+  [[nodiscard]] bool empty() const { return levels_.empty(); }
+
+  // Undefined when empty
+  [[nodiscard]] price_level best() const { return levels_.begin()->first; }
+
+  void clear()
+  {
+    levels_.clear();
+    boundary_  = price_level{};
+    dropped_   = 0;
+    truncated_ = false;
+  }
+};
+
+template <std::size_t Depth>
+class TruncatedDroFlatMapOrderbook {
+ public:
+  using price_level   = double;
+  using bid_container = TruncatedLadder<Depth, std::greater<price_level>>;
+  using ask_container = TruncatedLadder<Depth, std::less<price_level>>;
+
+ private:
+  bid_container bid_;
+  ask_container ask_;
+
+ public:
+  TruncatedDroFlatMapOrderbook() = default;
+
+  void build_sides(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    if (buy_sell == 'b') {
+      bid_.build(price, quantity);
+      return;
+    }
+    ask_.build(price, quantity);
+  }
+
+  void update_book(const char buy_sell, const double& price,
+                   const double& quantity)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.update(price, quantity);
+      return;
+    }
+    // Ask ///////////////
+    ask_.update(price, quantity);
+  }
+
+  // Remove every level from the touch through price, a sweep of the book
+  void erase_through(const char buy_sell, const double& price)
+  {
+    // Bid ///////////////
+    if (buy_sell == 'b') {
+      bid_.erase_through(price);
+      return;
+    }
+    // Ask ///////////////
+    ask_.erase_through(price);
+  }
+
+  void clear_book()
+  {
+    bid_.clear();
+    ask_.clear();
+  }
+
+  [[nodiscard]] bool is_crossed() const
+  {
+    if (ask_.empty() || bid_.empty()) {
+      return false;
+    }
+    return ask_.best() <= bid_.best();
+  }
+
+  [[nodiscard]] bool needs_resnapshot() const
+  {
+    return bid_.needs_resnapshot() || ask_.needs_resnapshot();
+  }
+
+  [[nodiscard]] std::size_t dropped_updates() const
+  {
+    return bid_.dropped() + ask_.dropped();
+  }
+
+  // Levels held across both sides
+  [[nodiscard]] std::size_t size() const { return bid_.size() + ask_.size(); }
+};
+}  // namespace gkp
@@ -0,0 +1,293 @@
+#include "benchmark/benchmark.h"
+#include "decimal_parser.h"
+#include "fast-double-parser/fast_double_parser.h"
+#include "frame_sample_data_generator.hpp"
+#include "frame_scanner.h"
+#include "glaze/glaze.hpp"
+#include "message_types.h"
+
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// The current MessageParser path
+struct GlazeParser {
+  template <typename Message>
+  static bool parse(const std::string_view json, Message& message)
+  {
+    return !glz::read_json(message, json);
+  }
+};
+
+struct ScannerParser {
+  template <typename Message>
+  static bool parse(const std::string_view json, Message& message)
+  {
+    return gkp::FrameScanner{json}.scan(message);
+  }
+};
+
+// Number parsers, each returns false on a string it can't take
+struct FastDoubleParser {
+  static bool parse(const std::string& text, double& value)
+  {
+    return fast_double_parser::parse_number(text.c_str(), &value) != nullptr;
+  }
+};
+
+struct FromChars {
+  static bool parse(const std::string& text, double& value)
+  {
+    return std::from_chars(text.data(), text.data() + text.size(), value).ec
+           == std::errc{};
+  }
+};
+
+struct FixedPointParser {
+  static bool parse(const std::string& text, double& value)
+  {
+    gkp::FixedPoint fixed;
+    return gkp::DecimalParser::parse(text, fixed)
+           && gkp::DecimalParser::toDouble(fixed, value);
+  }
+};
+
+// Straight to integer units of 1e-8, no double at all
+struct FixedPointUnits {
+  static bool parse(const std::string& text, double& value)
+  {
+    gkp::FixedPoint fixed;
+    uint64_t units{};
+    if (!gkp::DecimalParser::parse(text, fixed)
+        || !gkp::DecimalParser::toUnits(fixed, 8, units))
+    {
+      return false;
+    }
+    benchmark::DoNotOptimize(units);
+    value = 0.0;
+    return true;
+  }
+};
+
+// Every price and size string of the sample l2update frames
+std::vector<std::string>
+sampleNumbers()
+{
+  gkp::FrameSampleDataGenerator data;
+  std::vector<std::string> numbers;
+  gkp::L2UpdateMsg message;
+  for (const auto& frame : data.l2update_frames()) {
+    if (!gkp::FrameScanner{frame}.scan(message)) {
+      continue;
+    }
+    for (const auto& change : message.changes) {
+      numbers.emplace_back(change[1]);
+      numbers.emplace_back(change[2]);
+    }
+  }
+  return numbers;
+}
+
+// DecimalParser::parseDouble, with fast_double_parser as its fallback the way
+// MessageParser calls it, must give the same result as fast_double_parser
+// alone, bit for bit. Edge strings around the fixed point limits, then every
+// sample number
+bool
+checkNumbers()
+{
+  std::vector<std::string> numbers{
+      "0", "5.", ".5", "00.5", "01", "0.00000001", "43125.67",
+      // 19 and 20 digits, the most the fixed point path takes and one more
+      "1234567890123456789", "1234567890.123456789", "12345678901234567890",
+      "1234567890.1234567890",
+      // Either side of 2^53, where the mantissa stops being exact
+      "9007199254740991", "9007199254740992", "9007199254740993",
+      "900719925474099.1", "900719925474099.3", "9007199254740992.0",
+      "1e5", "-1.5", "", ".", "1.2.3"};
+  for (auto& number : sampleNumbers()) {
+    numbers.push_back(std::move(number));
+  }
+  std::size_t mismatches{};
+  for (const auto& number : numbers) {
+    double expected{};
+    const bool expectedValid = FastDoubleParser::parse(number, expected);
+    double value{};
+    const bool valid = gkp::DecimalParser::parseDouble(
+        number, value, [](const std::string_view text, double& result) {
+          return fast_double_parser::parse_number(text.data(), &result)
+                 != nullptr;
+        });
+    if (valid != expectedValid
+        || (valid
+            && std::bit_cast<uint64_t>(value)
+                   != std::bit_cast<uint64_t>(expected)))
+    {
+      std::cerr << "DecimalParser and fast_double_parser differ on \""
+                << number << "\"\n";
+      ++mismatches;
+    }
+  }
+  return mismatches == 0;
+}
+
+// Frames the scanner takes must read exactly as glaze reads them, and the
+// shapes it leaves to glaze must be declined rather than half read. Checked
+// once at startup, the timings mean nothing if the parsers disagree
+bool
+checkFrames()
+{
+  gkp::FrameSampleDataGenerator data;
+  std::vector<std::string> updates = data.l2update_frames();
+  // Same keys in another order, and no changes at all
+  updates.emplace_back(
+      R"({"time":"2024-11-17T20:42:27.265819Z","changes":[["sell","100.00",)"
+      R"("0.50000000"]],"product_id":"ETH-USD","type":"l2update"})");
+  updates.emplace_back(
+      R"({"type":"l2update","product_id":"BTC-USD","changes":[],"time":""})");
+  std::size_t mismatches{};
+  for (const auto& frame : updates) {
+    gkp::L2UpdateMsg scanned;
+    gkp::L2UpdateMsg read;
+    if (!ScannerParser::parse(frame, scanned)
+        || !GlazeParser::parse(frame, read) || scanned.type != read.type
+        || scanned.product_id != read.product_id || scanned.time != read.time
+        || scanned.changes != read.changes)
+    {
+      std::cerr << "FrameScanner and glaze differ on " << frame << '\n';
+      ++mismatches;
+    }
+  }
+  const std::string snapshot = data.snapshot_frame();
+  gkp::SnapshotMsg scanned;
+  gkp::SnapshotMsg read;
+  if (!ScannerParser::parse(snapshot, scanned)
+      || !GlazeParser::parse(snapshot, read) || scanned.type != read.type
+      || scanned.product_id != read.product_id || scanned.bids != read.bids
+      || scanned.asks != read.asks)
+  {
+    std::cerr << "FrameScanner and glaze differ on the snapshot frame\n";
+    ++mismatches;
+  }
+
+  // Whitespace, an escape, a non string value and a nested object
+  const std::vector<std::string> fallbacks{
+      R"({"type": "l2update","product_id":"BTC-USD","changes":[],"time":""})",
+      R"({"type":"l2update","product_id":"BTC\u002dUSD","changes":[],)"
+      R"("time":""})",
+      R"({"type":"l2update","product_id":"BTC-USD","changes":[["buy",100,)"
+      R"("1.0"]],"time":""})",
+      R"({"type":"l2update","product_id":"BTC-USD","changes":[],"time":{}})"};
+  for (const auto& frame : fallbacks) {
+    gkp::L2UpdateMsg declined;
+    if (ScannerParser::parse(frame, declined)) {
+      std::cerr << "FrameScanner should leave " << frame << " to glaze\n";
+      ++mismatches;
+    }
+  }
+  return mismatches == 0;
+}
+
+}  // namespace
+
+// Frames are std::strings, null terminated like the websocket buffer
+template <typename Parser>
+static void
+BM_Parse_L2Update(benchmark::State& state)
+{
+  using namespace gkp;
+  FrameSampleDataGenerator data;
+  const std::vector<std::string> frames = data.l2update_frames();
+  std::size_t bytes{};
+  for (const auto& frame : frames) {
+    bytes += frame.size();
+  }
+  L2UpdateMsg message;
+  std::size_t failed{};
+  // run benchmark
+  for (auto _ : state) {
+    for (const auto& frame : frames) {
+      if (!Parser::parse(frame, message)) {
+        ++failed;
+      }
+      benchmark::DoNotOptimize(message);
+    }
+  }
+  state.SetItemsProcessed(state.iterations()
+                          * static_cast<int64_t>(frames.size()));
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+  state.counters["failed"] = static_cast<double>(failed);
+}
+
+template <typename Parser>
+static void
+BM_Parse_Snapshot(benchmark::State& state)
+{
+  using namespace gkp;
+  FrameSampleDataGenerator data;
+  const std::string frame = data.snapshot_frame();
+  SnapshotMsg message;
+  std::size_t failed{};
+  // run benchmark
+  for (auto _ : state) {
+    if (!Parser::parse(frame, message)) {
+      ++failed;
+    }
+    benchmark::DoNotOptimize(message);
+  }
+  state.SetBytesProcessed(state.iterations()
+                          * static_cast<int64_t>(frame.size()));
+  state.counters["failed"] = static_cast<double>(failed);
+}
+
+template <typename Parser>
+static void
+BM_Parse_Number(benchmark::State& state)
+{
+  const std::vector<std::string> numbers = sampleNumbers();
+  std::size_t failed{};
+  double value{};
+  // run benchmark
+  for (auto _ : state) {
+    for (const auto& number : numbers) {
+      if (!Parser::parse(number, value)) {
+        ++failed;
+      }
+      benchmark::DoNotOptimize(value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations()
+                          * static_cast<int64_t>(numbers.size()));
+  state.counters["failed"] = static_cast<double>(failed);
+}
+
+BENCHMARK_TEMPLATE(BM_Parse_L2Update, GlazeParser);
+BENCHMARK_TEMPLATE(BM_Parse_L2Update, ScannerParser);
+BENCHMARK_TEMPLATE(BM_Parse_Snapshot, GlazeParser);
+BENCHMARK_TEMPLATE(BM_Parse_Snapshot, ScannerParser);
+BENCHMARK_TEMPLATE(BM_Parse_Number, FastDoubleParser);
+BENCHMARK_TEMPLATE(BM_Parse_Number, FromChars);
+BENCHMARK_TEMPLATE(BM_Parse_Number, FixedPointParser);
+BENCHMARK_TEMPLATE(BM_Parse_Number, FixedPointUnits);
+
+// Run the benchmark, once the fast paths are known to match
+int
+main(int argc, char** argv)
+{
+  if (!checkNumbers() || !checkFrames()) {
+    return 1;
+  }
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,279 @@
+#include "benchmark/benchmark.h"
+#include "book_event.h"
+#include "broadcast_ring.h"
+#include "orderbook.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t ITERATIONS       = 10'000;
+constexpr std::size_t LEVEL_QTY        = 1'000;
+constexpr std::size_t initial_best_ask = 100'001;
+constexpr std::size_t initial_best_bid = 100'000;
+// Most updates land within a few levels of the touch, so most publish
+constexpr double TOUCH_PROBABILITY     = 0.25;
+constexpr std::size_t RING_CAPACITY    = 4'096;
+// One event in this many carries a publish time, a clock read per event would
+// cost more than the publish it measures
+constexpr uint64_t LATENCY_STRIDE       = 64;
+
+struct Message {
+  char buySell_{};
+  double price_{};
+  double quantity_{};
+};
+
+// Per reader counters, a cache line each so readers don't share one
+struct alignas(64) ReaderStats {
+  std::size_t reads_{};
+  std::size_t retries_{};
+  // Versions published between two reads of the same reader
+  std::size_t versionsBehind_{};
+};
+
+struct alignas(64) ConsumerStats {
+  std::size_t events_{};
+  std::size_t missed_{};
+  // Over the stamped events only
+  std::size_t latencySamples_{};
+  int64_t latencyTotal_{};
+  int64_t latencyMax_{};
+};
+
+int64_t
+nowNanos()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+std::vector<Message>
+makeMessages()
+{
+  std::minstd_rand generator{0};
+  std::geometric_distribution<std::size_t> distance{TOUCH_PROBABILITY};
+  std::vector<Message> messages;
+  messages.reserve(ITERATIONS);
+  for (std::size_t i{}; i < ITERATIONS; ++i) {
+    const bool bid        = (generator() & 1) != 0;
+    const std::size_t gap = distance(generator) % LEVEL_QTY;
+    const auto price      = static_cast<double>(
+        bid ? initial_best_bid - gap : initial_best_ask + gap);
+    messages.push_back(Message{bid ? 'b' : 's', price,
+                               static_cast<double>(generator() % 4)});
+  }
+  return messages;
+}
+
+bool
+pinThread(const std::size_t core)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(core, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+}  // namespace
+
+// 1 writer applying updates and publishing the top through the seqlock, with
+// range(0) readers pinned to their own cores polling it. Compare the time
+// against /0 for the writer slowdown, versions_behind is reader staleness.
+static void
+BM_SeqlockPublish(benchmark::State& state)
+{
+  using namespace gkp;
+  const auto readers = static_cast<std::size_t>(state.range(0));
+  if (readers + 1 > std::thread::hardware_concurrency()) {
+    state.SkipWithError("Not enough cores for the readers");
+    return;
+  }
+
+  OrderbookOptions options;
+  options.publishTop = true;
+  LimitOrderBook book{"BENCH", options};
+  LimitOrderBook::top_seqlock top;
+  book.setPublisher(&top);
+  for (std::size_t i{}; i < LEVEL_QTY; ++i) {
+    book.buildSides(true, static_cast<double>(initial_best_bid - i), 1.0);
+    book.buildSides(false, static_cast<double>(initial_best_ask + i), 1.0);
+  }
+  book.publishTop();
+  const std::vector<Message> messages = makeMessages();
+
+  cpu_set_t original;
+  pthread_getaffinity_np(pthread_self(), sizeof(original), &original);
+  pinThread(0);
+
+  std::atomic<bool> running{true};
+  std::vector<ReaderStats> stats(readers);
+  std::vector<std::thread> threads;
+  threads.reserve(readers);
+  for (std::size_t reader{}; reader < readers; ++reader) {
+    threads.emplace_back([&top, &running, &stats, reader] {
+      pinThread(reader + 1);
+      ReaderStats& stat = stats[reader];
+      PublishedTop copy;
+      uint64_t version{};
+      uint64_t previous = top.load(copy);
+      while (running.load(std::memory_order_relaxed)) {
+        while (!top.tryLoad(copy, version)) {
+          ++stat.retries_;
+        }
+        ++stat.reads_;
+        stat.versionsBehind_ += version - previous;
+        previous              = version;
+        benchmark::DoNotOptimize(copy);
+      }
+    });
+  }
+
+  // run benchmark
+  for (auto _ : state) {
+    for (const auto& message : messages) {
+      book.updateBook(message.buySell_, message.price_, message.quantity_);
+    }
+  }
+
+  running.store(false, std::memory_order_relaxed);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(original), &original);
+
+  ReaderStats total;
+  for (const auto& stat : stats) {
+    total.reads_          += stat.reads_;
+    total.retries_        += stat.retries_;
+    total.versionsBehind_ += stat.versionsBehind_;
+  }
+  state.SetItemsProcessed(state.iterations()
+                          * static_cast<int64_t>(ITERATIONS));
+  state.counters["publishes"] = benchmark::Counter(
+      static_cast<double>(top.version()), benchmark::Counter::kAvgIterations);
+  if (total.reads_ != 0) {
+    const auto reads                  = static_cast<double>(total.reads_);
+    state.counters["reads"]           = reads;
+    state.counters["retry_ratio"]     =
+        static_cast<double>(total.retries_) / reads;
+    state.counters["versions_behind"] =
+        static_cast<double>(total.versionsBehind_) / reads;
+  }
+}
+
+BENCHMARK(BM_SeqlockPublish)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// 1 producer broadcasting book events through the ring to range(0) consumers
+// pinned to their own cores. Time per item is the producer cost, latency is
+// publish to read over every LATENCY_STRIDE-th event and missed counts events
+// lost to lagging.
+static void
+BM_BroadcastRing(benchmark::State& state)
+{
+  using namespace gkp;
+  const auto consumers = static_cast<std::size_t>(state.range(0));
+  if (consumers + 1 > std::thread::hardware_concurrency()) {
+    state.SkipWithError("Not enough cores for the consumers");
+    return;
+  }
+
+  BroadcastRing<BookEvent> ring{RING_CAPACITY};
+  const std::vector<Message> messages = makeMessages();
+
+  cpu_set_t original;
+  pthread_getaffinity_np(pthread_self(), sizeof(original), &original);
+  pinThread(0);
+
+  std::atomic<bool> running{true};
+  std::atomic<std::size_t> ready{};
+  std::vector<ConsumerStats> stats(consumers);
+  std::vector<std::thread> threads;
+  threads.reserve(consumers);
+  for (std::size_t consumer{}; consumer < consumers; ++consumer) {
+    threads.emplace_back([&ring, &running, &ready, &stats, consumer] {
+      pinThread(consumer + 1);
+      ConsumerStats& stat = stats[consumer];
+      BroadcastRing<BookEvent>::Consumer cursor{ring};
+      ready.fetch_add(1, std::memory_order_release);
+      BookEvent event;
+      while (running.load(std::memory_order_relaxed)) {
+        if (cursor.poll(event) != RingRead::Event) {
+          continue;
+        }
+        ++stat.events_;
+        if (event.publishTime_ == 0) {
+          continue;
+        }
+        const int64_t latency  = nowNanos() - event.publishTime_;
+        ++stat.latencySamples_;
+        stat.latencyTotal_    += latency;
+        stat.latencyMax_       = std::max(stat.latencyMax_, latency);
+      }
+      stat.missed_ = cursor.missed();
+    });
+  }
+  while (ready.load(std::memory_order_acquire) != consumers) {
+  }
+
+  // run benchmark
+  uint64_t sequence{};
+  for (auto _ : state) {
+    for (const auto& message : messages) {
+      ++sequence;
+      ring.publish(BookEvent{
+          .type_        = BookEventType::Update,
+          .side_        = message.buySell_,
+          .price_       = message.price_,
+          .quantity_    = message.quantity_,
+          .sequence_    = sequence,
+          .publishTime_ = (sequence % LATENCY_STRIDE == 0) ? nowNanos() : 0});
+    }
+  }
+
+  running.store(false, std::memory_order_relaxed);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(original), &original);
+
+  ConsumerStats total;
+  for (const auto& stat : stats) {
+    total.events_         += stat.events_;
+    total.missed_         += stat.missed_;
+    total.latencySamples_ += stat.latencySamples_;
+    total.latencyTotal_   += stat.latencyTotal_;
+    total.latencyMax_      = std::max(total.latencyMax_, stat.latencyMax_);
+  }
+  state.SetItemsProcessed(state.iterations()
+                          * static_cast<int64_t>(ITERATIONS));
+  if (total.events_ != 0) {
+    const auto events              = static_cast<double>(total.events_);
+    state.counters["missed_ratio"] =
+        static_cast<double>(total.missed_)
+        / (events + static_cast<double>(total.missed_));
+  }
+  if (total.latencySamples_ != 0) {
+    state.counters["latency_mean_ns"] =
+        static_cast<double>(total.latencyTotal_)
+        / static_cast<double>(total.latencySamples_);
+    state.counters["latency_max_ns"]  =
+        static_cast<double>(total.latencyMax_);
+  }
+}
+
+BENCHMARK(BM_BroadcastRing)->Arg(1)->Arg(4)->Arg(8)->UseRealTime();
+
+// Run the benchmark
+BENCHMARK_MAIN();
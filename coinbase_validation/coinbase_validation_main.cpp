@@ -1,8 +1,7 @@
 #include "common.h"
 #include "glaze/glaze.hpp"
-#include "loop.h"
-#include "message_parser.h"
 #include "message_types.h"
+#include "shard.h"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/classification.hpp>
@@ -10,33 +9,131 @@
 #include <boost/algorithm/string/split.hpp>
 #include <boost/program_options.hpp>
 
+#include <charconv>
 #include <chrono>
 #include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 void
-printUserSelection(const gkp::SubscribeMsg& sub)
+printUserSelection(const std::vector<gkp::SubscribeMsg>& shards)
 {
   std::cout << "User Selection:\nProduct IDs:\n";
-  for (const auto& symbol : sub.product_ids) {
-    std::cout << "- " << symbol << '\n';
+  for (std::size_t shard{}; shard < shards.size(); ++shard) {
+    if (shards.size() > 1) {
+      std::cout << "Shard " << shard << ":\n";
+    }
+    for (const auto& symbol : shards[shard].product_ids) {
+      std::cout << "- " << symbol << '\n';
+    }
   }
   std::cout << "\nPress Ctrl+C to stop.\n";
 }
 
+// Comma separated whole numbers above 0, prints the offending entry and
+// returns false otherwise
+bool
+parseBucketMultipliers(const std::string& list,
+                       std::vector<std::size_t>& multipliers)
+{
+  std::vector<std::string> buckets;
+  boost::split(buckets, list, boost::is_any_of(","), boost::token_compress_on);
+  for (const auto& bucket : buckets) {
+    std::size_t multiplier{};
+    const char* end      = bucket.data() + bucket.size();
+    const auto [ptr, ec] = std::from_chars(bucket.data(), end, multiplier);
+    if (ec != std::errc{} || ptr != end || multiplier == 0) {
+      std::cerr << "Invalid --bucket-multipliers entry \"" << bucket
+                << "\", expected whole numbers above 0\n";
+      return false;
+    }
+    multipliers.push_back(multiplier);
+  }
+  return true;
+}
+
 int
 main(int argc, char* argv[])
 {
-  constexpr auto helpOpt     = "help";
-  constexpr auto productsOpt = "products";
+  constexpr auto helpOpt          = "help";
+  constexpr auto productsOpt      = "products";
+  constexpr auto depthCacheOpt    = "depth-cache";
+  constexpr auto maxDepthOpt      = "max-depth";
+  constexpr auto tickSizeOpt      = "tick-size";
+  constexpr auto bucketsOpt       = "bucket-multipliers";
+  constexpr auto publishTopOpt    = "publish-top";
+  constexpr auto shmNameOpt       = "shm-name";
+  constexpr auto eventsOpt        = "event-capacity";
+  constexpr auto bboOpt           = "bbo-capacity";
+  constexpr auto pipelineOpt      = "pipeline";
+  constexpr auto ringSlotsOpt     = "ring-slots";
+  constexpr auto networkCpuOpt    = "network-cpu";
+  constexpr auto processingCpuOpt = "processing-cpu";
+  constexpr auto parseWorkersOpt  = "parse-workers";
+  constexpr auto snapshotOpt      = "snapshot-workers";
+  constexpr auto shardsOpt        = "shards";
+  constexpr auto telemetryOpt     = "telemetry-shm";
+  constexpr auto quietOpt         = "quiet";
 
   std::string productsDefault{"BTC-USD,ETH-USD"};
+  std::string bucketsDefault{"10,100"};
 
   namespace progOpt = boost::program_options;
   progOpt::options_description desc("Options");
   desc.add_options()(helpOpt, "Print help message.")(
       productsOpt,
       progOpt::value<std::string>()->default_value(productsDefault),
-      "Products IDs, comma separated.");
+      "Products IDs, comma separated.")(
+      depthCacheOpt, progOpt::bool_switch(),
+      "Maintain a top of book depth cache per side.")(
+      maxDepthOpt, progOpt::value<std::size_t>()->default_value(0),
+      "Levels retained per side, 0 keeps every level.")(
+      tickSizeOpt, progOpt::value<double>()->default_value(0.0),
+      "Native tick size, enables bucketed ladders when set.")(
+      bucketsOpt, progOpt::value<std::string>()->default_value(bucketsDefault),
+      "Bucket sizes in ticks, comma separated.")(
+      publishTopOpt, progOpt::bool_switch(),
+      "Publish the top of book to reader threads through a seqlock.")(
+      shmNameOpt, progOpt::value<std::string>()->default_value(""),
+      "Publish the top of book to other processes in this POSIX shared "
+      "memory segment, e.g. /coinbase_books.")(
+      eventsOpt, progOpt::value<std::size_t>()->default_value(0),
+      "Broadcast book changes to consumer threads through a ring of this many "
+      "events, rounded up to a power of two. 0 disables it.")(
+      bboOpt, progOpt::value<std::size_t>()->default_value(0),
+      "Broadcast best bid and offer changes through a ring of this many "
+      "events, rounded up to a power of two. 0 disables it.")(
+      pipelineOpt, progOpt::bool_switch(),
+      "Receive on the network thread and parse and apply the frames on a "
+      "processing thread, connected by a ring.")(
+      ringSlotsOpt, progOpt::value<std::size_t>()->default_value(1024),
+      "Frames the pipeline ring holds, rounded up to a power of two.")(
+      networkCpuOpt, progOpt::value<int>()->default_value(-1),
+      "Core to pin the network thread to, -1 doesn't pin.")(
+      processingCpuOpt, progOpt::value<int>()->default_value(-1),
+      "Core to pin the processing thread to, -1 doesn't pin.")(
+      parseWorkersOpt, progOpt::value<std::size_t>()->default_value(0),
+      "Parse frames on this many worker threads and apply them in arrival "
+      "order per product on the processing thread. 0 parses on the "
+      "processing thread.")(
+      snapshotOpt, progOpt::value<std::size_t>()->default_value(0),
+      "Parse snapshots and build their books on this many loader threads, "
+      "holding each product's updates until its book is ready. 0 builds "
+      "them where the frames are applied.")(
+      shardsOpt, progOpt::value<std::size_t>()->default_value(1),
+      "Spread the products over this many connections, each with its own "
+      "io_context thread and books. Each shard pins to the next block of "
+      "cores after the previous shard's and the shared memory segments are "
+      "named <name>.<shard>.")(
+      telemetryOpt, progOpt::value<std::string>()->default_value(""),
+      "Publish counters and latency histograms to this POSIX shared memory "
+      "segment, e.g. /coinbase_telemetry, for Telemetry_Reader.")(
+      quietOpt, progOpt::bool_switch(),
+      "Don't print the books and statistics every 5 seconds, read them from "
+      "the telemetry segment instead.");
 
   progOpt::variables_map varsMap;
   progOpt::store(progOpt::parse_command_line(argc, argv, desc), varsMap);
@@ -47,30 +144,66 @@ main(int argc, char* argv[])
     return 0;
   }
 
+  // Validate the book options before connecting anywhere
+  gkp::OrderbookOptions bookOptions;
+  bookOptions.tickSize = varsMap[tickSizeOpt].as<double>();
+  if (!varsMap[tickSizeOpt].defaulted() && !(bookOptions.tickSize > 0.0)) {
+    std::cerr << "--tick-size must be above 0\n";
+    return 1;
+  }
+  if (!parseBucketMultipliers(varsMap[bucketsOpt].as<std::string>(),
+                              bookOptions.bucketMultipliers))
+  {
+    return 1;
+  }
+
   // Parse user input, and print to terminal
   gkp::SubscribeMsg sub;
   boost::split(sub.product_ids, varsMap[productsOpt].as<std::string>(),
                boost::is_any_of(","), boost::token_compress_on);
-  printUserSelection(sub);
+  const std::vector<gkp::SubscribeMsg> shardSubs =
+      gkp::splitProducts(sub, varsMap[shardsOpt].as<std::size_t>());
 
-  // Initialize IO Context and SSL
+  gkp::PipelineOptions pipelineOptions;
+  pipelineOptions.enabled         = varsMap[pipelineOpt].as<bool>();
+  pipelineOptions.ringSlots       = varsMap[ringSlotsOpt].as<std::size_t>();
+  pipelineOptions.networkCpu      = varsMap[networkCpuOpt].as<int>();
+  pipelineOptions.processingCpu   = varsMap[processingCpuOpt].as<int>();
+  pipelineOptions.parseWorkers    = varsMap[parseWorkersOpt].as<std::size_t>();
+  pipelineOptions.snapshotWorkers = varsMap[snapshotOpt].as<std::size_t>();
+  if (!gkp::checkShardCores(pipelineOptions, shardSubs.size())) {
+    return 1;
+  }
+  printUserSelection(shardSubs);
+
+  // Initialize SSL, shared by every connection
   namespace ssl = boost::asio::ssl;
-  io_context ioc;
   ssl_context ctx{ssl::context::tlsv12_client};
   ctx.set_default_verify_paths();
   ctx.set_verify_mode(ssl::verify_peer);
 
-  // Main Class
-  gkp::MessageParser parser{sub, ioc, ctx};
+  bookOptions.depthCache    = varsMap[depthCacheOpt].as<bool>();
+  bookOptions.maxDepth      = varsMap[maxDepthOpt].as<std::size_t>();
+  bookOptions.publishTop    = varsMap[publishTopOpt].as<bool>();
+  bookOptions.shmName       = varsMap[shmNameOpt].as<std::string>();
+  bookOptions.eventCapacity = varsMap[eventsOpt].as<std::size_t>();
+  bookOptions.bboCapacity   = varsMap[bboOpt].as<std::size_t>();
+  bookOptions.telemetryName = varsMap[telemetryOpt].as<std::string>();
+
+  // One connection per shard, the first runs on this thread
+  std::mutex printMutex;
+  std::vector<std::unique_ptr<gkp::Shard>> shards;
+  for (std::size_t i{}; i < shardSubs.size(); ++i) {
+    shards.push_back(std::make_unique<gkp::Shard>(
+        i, shardSubs.size(), shardSubs[i], ctx, bookOptions, pipelineOptions,
+        printMutex));
+  }
 
-  // Set Loop Callback
   constexpr uint16_t depth = 5;
   const std::chrono::seconds intervalTime{5};
-  gkp::Loop loop{ioc, intervalTime, [&parser, &depth]() mutable {
-                   parser.printOrderbookWithStats(depth);
-                 }};
-
-  // Start DataStream
-  parser.subscribeToMarketData();
-  ioc.run();
+  const bool printing = !varsMap[quietOpt].as<bool>();
+  for (std::size_t i{1}; i < shards.size(); ++i) {
+    shards[i]->start(intervalTime, depth, printing);
+  }
+  shards.front()->run(intervalTime, depth, printing);
 }
@@ -0,0 +1,88 @@
+#pragma once
+// Header Guard
+
+#include "dro/flat-rb-tree.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace gkp {
+
+struct AggregatedLevel {
+  double quantity_{};
+  // Book levels inside the bucket, the bucket goes when the last one does
+  uint32_t levels_{};
+};
+
+// One side of the book bucketed at multiplier times the native tick. Every
+// book change is applied as a quantity delta into its bucket, so reading the
+// bucketed view never walks the underlying book. Bid buckets round prices
+// down and ask buckets round them up, a bucket never reaches past the touch.
+template <typename Compare>
+class AggregatedLadder {
+ public:
+  using bucket_type = int64_t;
+  using bucket_map  = dro::FlatMap<bucket_type, AggregatedLevel, uint32_t,
+                                   Compare>;
+
+ private:
+  constexpr static bool roundUp = Compare{}(0, 1);
+  bucket_map buckets_;
+  double tickSize_{};
+  int64_t multiplier_{1};
+
+  [[nodiscard]] bucket_type bucket(const double price) const
+  {
+    const int64_t ticks = std::llround(price / tickSize_);
+    if constexpr (roundUp) {
+      return (ticks + multiplier_ - 1) / multiplier_;
+    }
+    return ticks / multiplier_;
+  }
+
+ public:
+  AggregatedLadder(const double tickSize, const std::size_t multiplier)
+      : tickSize_(tickSize), multiplier_(static_cast<int64_t>(multiplier))
+  {}
+
+  // delta is the new quantity minus the old one. levelDelta is +1 for a new
+  // level, -1 for an erased one and 0 for a quantity change
+  void apply(const double price, const double delta, const int levelDelta)
+  {
+    const bucket_type key = bucket(price);
+    const auto it         = buckets_.emplace(key).first;
+    it->second.quantity_ += delta;
+    it->second.levels_    = static_cast<uint32_t>(
+        static_cast<int64_t>(it->second.levels_) + levelDelta);
+    if (it->second.levels_ == 0) {
+      buckets_.erase(it);
+    }
+  }
+
+  // Calls function(price, quantity) for the best depth buckets
+  template <typename Function>
+  void forEach(const std::size_t depth, Function&& function) const
+  {
+    const double bucketSize = tickSize_ * static_cast<double>(multiplier_);
+    std::size_t count{};
+    for (auto it = buckets_.begin(); count < depth && it != buckets_.end();
+         ++count, ++it)
+    {
+      function(static_cast<double>(it->first) * bucketSize,
+               it->second.quantity_);
+    }
+  }
+
+  [[nodiscard]] std::size_t multiplier() const
+  {
+    return static_cast<std::size_t>(multiplier_);
+  }
+
+  [[nodiscard]] std::size_t size() const { return buckets_.size(); }
+
+  [[nodiscard]] bool empty() const { return buckets_.empty(); }
+
+  void clear() { buckets_.clear(); }
+};
+}  // namespace gkp
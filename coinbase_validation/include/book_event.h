@@ -0,0 +1,43 @@
+#pragma once
+// Header Guard
+
+#include "published_top.h"
+
+#include <cstdint>
+
+namespace gkp {
+
+enum class BookEventType : uint8_t {
+  Update,    // One level changed
+  Snapshot,  // The book was rebuilt, reread its top
+};
+
+// Book change broadcast by MessageParser, trivially copyable for the ring
+struct BookEvent {
+  // Index of the product in the subscription
+  uint16_t productIndex_{};
+  BookEventType type_{};
+  // 'b' or 's', unset for a snapshot
+  char side_{};
+  double price_{};
+  // New level quantity, zero when the level was removed
+  double quantity_{};
+  // LimitOrderBook::updateCount() once the change was applied
+  uint64_t sequence_{};
+  // Clock (steady_clock) nanoseconds when the message was received and when
+  // the event was published
+  int64_t receiveTime_{};
+  int64_t publishTime_{};
+};
+
+// Sent only when the best bid or ask price or quantity changed, at most once
+// per message
+struct BboEvent {
+  uint16_t productIndex_{};
+  Bbo bbo_{};
+  // Same meaning as in BookEvent
+  uint64_t sequence_{};
+  int64_t receiveTime_{};
+  int64_t publishTime_{};
+};
+}  // namespace gkp
@@ -0,0 +1,139 @@
+#pragma once
+// Header Guard
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace gkp {
+
+enum class RingRead : uint8_t {
+  Empty,   // Nothing new yet
+  Event,   // value holds the next event
+  Lagged,  // Overwritten before it was read, the consumer skipped ahead
+};
+
+// Single producer, many consumers, each consumer reads every event at its
+// own pace through its own cursor. The producer never waits: it overwrites
+// the oldest slot, and a consumer more than capacity events behind finds its
+// slot reused and is told it lagged. Each slot is a small seqlock whose
+// sequence also names the event it holds.
+template <typename T>
+class BroadcastRing {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Ring events are copied with memcpy");
+
+ private:
+  constexpr static std::size_t cacheLine = 64;
+
+  struct alignas(cacheLine) Slot {
+    // 2n + 1 while event n is written, 2n + 2 once it's complete
+    std::atomic<uint64_t> sequence_{};
+    T value_{};
+  };
+
+  // Events published so far, only read by consumers
+  alignas(cacheLine) std::atomic<uint64_t> head_{};
+  alignas(cacheLine) std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+ public:
+  // capacity is rounded up to a power of two
+  explicit BroadcastRing(const std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? 2 : capacity) - 1),
+        slots_(std::make_unique<Slot[]>(mask_ + 1))
+  {
+  }
+
+  ~BroadcastRing() = default;
+  // Non-copyable & Non-moveable
+  BroadcastRing(const BroadcastRing&)            = delete;
+  BroadcastRing& operator=(const BroadcastRing&) = delete;
+  BroadcastRing(BroadcastRing&&)                 = delete;
+  BroadcastRing& operator=(BroadcastRing&&)      = delete;
+
+  // Producer thread only
+  void publish(const T& value)
+  {
+    const uint64_t event = head_.load(std::memory_order_relaxed);
+    Slot& slot           = slots_[event & mask_];
+    slot.sequence_.store((2 * event) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.value_, &value, sizeof(T));
+    slot.sequence_.store((2 * event) + 2, std::memory_order_release);
+    head_.store(event + 1, std::memory_order_release);
+  }
+
+  [[nodiscard]] uint64_t head() const
+  {
+    return head_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] std::size_t capacity() const { return mask_ + 1; }
+
+  // Reads event number event into value. Empty when it isn't complete yet,
+  // Lagged when the slot already holds a later event
+  [[nodiscard]] RingRead tryRead(const uint64_t event, T& value) const
+  {
+    const Slot& slot      = slots_[event & mask_];
+    const uint64_t wanted = (2 * event) + 2;
+    const uint64_t before = slot.sequence_.load(std::memory_order_acquire);
+    if (before < wanted) {
+      return RingRead::Empty;
+    }
+    if (before > wanted) {
+      return RingRead::Lagged;
+    }
+    std::memcpy(&value, &slot.value_, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (slot.sequence_.load(std::memory_order_relaxed) == before)
+               ? RingRead::Event
+               : RingRead::Lagged;
+  }
+
+  // One per consumer thread, starts at the next event published
+  class Consumer {
+   private:
+    const BroadcastRing* ring_;
+    uint64_t next_;
+    uint64_t missed_{};
+
+   public:
+    explicit Consumer(const BroadcastRing& ring)
+        : ring_(&ring), next_(ring.head())
+    {
+    }
+
+    // On Lagged the cursor moves to the oldest event still in the ring and
+    // the skipped events are counted in missed(), poll again to go on
+    RingRead poll(T& value)
+    {
+      const RingRead read = ring_->tryRead(next_, value);
+      if (read == RingRead::Event) {
+        ++next_;
+      } else if (read == RingRead::Lagged) {
+        const uint64_t head   = ring_->head();
+        const uint64_t oldest = (head > ring_->capacity())
+                                    ? head - ring_->capacity()
+                                    : 0;
+        // The producer may lap the cursor again before the next poll
+        const uint64_t resume = std::max(oldest + 1, next_ + 1);
+        missed_              += resume - next_;
+        next_                 = resume;
+      }
+      return read;
+    }
+
+    // Events skipped after lagging behind the producer
+    [[nodiscard]] uint64_t missed() const { return missed_; }
+
+    // Events published but not read yet
+    [[nodiscard]] uint64_t backlog() const { return ring_->head() - next_; }
+  };
+};
+}  // namespace gkp
@@ -0,0 +1,9 @@
+#pragma once
+// Header Guard
+
+#include <chrono>
+
+// Every timestamp and interval in the feed handler, common.h adds the asio
+// types on top. Kept apart so the message types don't pull in boost
+using Clock    = std::chrono::steady_clock;
+using Duration = std::chrono::nanoseconds;
@@ -1,6 +1,8 @@
 #pragma once
 // Header Guard
 
+#include "clock.h"
+
 #include <boost/asio/basic_waitable_timer.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/post.hpp>
@@ -9,9 +11,6 @@
 
 #include <chrono>
 
-using Clock       = std::chrono::steady_clock;
-using Duration    = std::chrono::nanoseconds;
-
 using Timer       = boost::asio::basic_waitable_timer<Clock>;
 using io_context  = boost::asio::io_context;
 using ssl_context = boost::asio::ssl::context;
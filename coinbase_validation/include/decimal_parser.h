@@ -0,0 +1,173 @@
+#pragma once
+// Header Guard
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace gkp {
+
+// Decimal string as an integer and the digits after the point, exact
+struct FixedPoint {
+  uint64_t mantissa_{};
+  uint32_t decimals_{};
+};
+
+// Parses the fixed precision decimals Coinbase sends, such as "43125.67" or
+// "0.00150000", into a FixedPoint, in one pass with no exponent handling.
+// Fraction digits are checked and converted eight at a time inside a 64 bit
+// word. Signs, exponents and more than 19 digits are rejected, the caller
+// falls back to a general parser for those.
+class DecimalParser {
+ private:
+  // Exactly representable powers of ten, a division by them is correctly
+  // rounded
+  constexpr static std::array<double, 23> powers{
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  constexpr static std::array<uint64_t, 20> integerPowers = [] {
+    std::array<uint64_t, 20> result{};
+    uint64_t power{1};
+    for (auto& value : result) {
+      value  = power;
+      power *= 10;
+    }
+    return result;
+  }();
+  constexpr static uint64_t maxExact{uint64_t{1} << 53};
+  constexpr static std::size_t maxDigits{19};
+
+  [[nodiscard]] static uint64_t load8(const char* chars)
+  {
+    uint64_t word{};
+    std::memcpy(&word, chars, sizeof(word));
+    if constexpr (std::endian::native == std::endian::big) {
+      word = std::byteswap(word);
+    }
+    return word;
+  }
+
+  [[nodiscard]] static bool allDigits(const uint64_t word)
+  {
+    return ((word & 0xF0F0F0F0F0F0F0F0)
+            | (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+           == 0x3333333333333333;
+  }
+
+  // Eight ASCII digits, first in the lowest byte, to their value
+  [[nodiscard]] static uint64_t convert8(uint64_t word)
+  {
+    constexpr uint64_t mask = 0x000000FF000000FF;
+    constexpr uint64_t mul1 = 100 + (1000000ULL << 32);
+    constexpr uint64_t mul2 = 1 + (10000ULL << 32);
+    word -= 0x3030303030303030;
+    word  = (word * 10) + (word >> 8);
+    return (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+  }
+
+  // Appends digits to mantissa until the first non digit
+  [[nodiscard]] static const char* readDigits(const char* it,
+                                              const char* const end,
+                                              uint64_t& mantissa,
+                                              std::size_t& digits)
+  {
+    for (; it != end; ++it) {
+      const auto digit = static_cast<uint64_t>(
+          static_cast<unsigned char>(*it) - static_cast<unsigned char>('0'));
+      if (digit > 9) {
+        break;
+      }
+      mantissa = (mantissa * 10) + digit;
+      ++digits;
+    }
+    return it;
+  }
+
+ public:
+  // False unless the whole of text is a JSON number without sign or
+  // exponent, digits on both sides of any point and no leading zeros, so
+  // it takes nothing the fallback would reject
+  [[nodiscard]] static bool parse(const std::string_view text,
+                                  FixedPoint& value)
+  {
+    const char* it        = text.data();
+    const char* const end = it + text.size();
+    uint64_t mantissa{};
+    std::size_t digits{};
+    // Integer parts of prices and sizes are short, a word probe doesn't pay
+    it = readDigits(it, end, mantissa, digits);
+    const std::size_t integerDigits = digits;
+    if (integerDigits == 0 || (integerDigits > 1 && text.front() == '0')) {
+      return false;
+    }
+    if (it != end && *it == '.') {
+      ++it;
+      // Sizes carry 8 decimals, convert whole words of them at once
+      while (end - it >= 8 && digits <= maxDigits) {
+        const uint64_t word = load8(it);
+        if (!allDigits(word)) {
+          break;
+        }
+        mantissa  = (mantissa * 100'000'000) + convert8(word);
+        digits   += 8;
+        it       += 8;
+      }
+      it = readDigits(it, end, mantissa, digits);
+      if (digits == integerDigits) {
+        return false;
+      }
+    }
+    // Past maxDigits the mantissa may have wrapped
+    if (it != end || digits > maxDigits) {
+      return false;
+    }
+    value.mantissa_ = mantissa;
+    value.decimals_ = static_cast<uint32_t>(digits - integerDigits);
+    return true;
+  }
+
+  // Same double a correctly rounded parser returns, false when the value
+  // has too many digits for that to be exact
+  [[nodiscard]] static bool toDouble(const FixedPoint& value, double& result)
+  {
+    if (value.mantissa_ > maxExact || value.decimals_ >= powers.size()) {
+      return false;
+    }
+    result = static_cast<double>(value.mantissa_) / powers[value.decimals_];
+    return true;
+  }
+
+  // Integer count of 10^-decimals units, e.g. ticks of 0.01 with decimals 2.
+  // False when the value isn't a whole number of units or overflows
+  [[nodiscard]] static bool toUnits(const FixedPoint& value,
+                                    const uint32_t decimals, uint64_t& units)
+  {
+    if (value.decimals_ > maxDigits || decimals > maxDigits) {
+      return false;
+    }
+    if (value.decimals_ >= decimals) {
+      const uint64_t scale = integerPowers[value.decimals_ - decimals];
+      units                = value.mantissa_ / scale;
+      return value.mantissa_ % scale == 0;
+    }
+    const uint64_t scale = integerPowers[decimals - value.decimals_];
+    units                = value.mantissa_ * scale;
+    return value.mantissa_ <= UINT64_MAX / scale;
+  }
+
+  // Fixed point first, anything else through fallback(text, result)
+  template <typename Fallback>
+  [[nodiscard]] static bool parseDouble(const std::string_view text,
+                                        double& result, Fallback&& fallback)
+  {
+    FixedPoint value;
+    if (parse(text, value) && toDouble(value, result)) {
+      return true;
+    }
+    return fallback(text, result);
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,113 @@
+#pragma once
+// Header Guard
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gkp {
+
+struct DepthLevel {
+  double price_{};
+  double quantity_{};
+
+  bool operator==(const DepthLevel&) const = default;
+};
+
+// Top Depth levels of one side in a fixed array, best price first. The
+// owning book keeps it current, so reading depth is a copy of a few cache
+// lines instead of an iterator walk.
+template <std::size_t Depth, typename Compare>
+class DepthCache {
+ public:
+  using levels_type = std::array<DepthLevel, Depth>;
+
+ private:
+  levels_type levels_{};
+  std::size_t size_{};
+  Compare compare_{};
+
+  // Index of the first cached level not ordered before price
+  [[nodiscard]] std::size_t position(const double price) const
+  {
+    std::size_t index{};
+    for (; index < size_ && compare_(levels_[index].price_, price); ++index) {
+    }
+    return index;
+  }
+
+  [[nodiscard]] bool isSame(const std::size_t index, const double price) const
+  {
+    return index < size_ && !compare_(price, levels_[index].price_);
+  }
+
+ public:
+  // A change at price lands inside the cache, always true while the cache
+  // holds every level of the side
+  [[nodiscard]] bool covers(const double price) const
+  {
+    return size_ < Depth || !compare_(levels_[size_ - 1].price_, price);
+  }
+
+  void upsert(const double price, const double quantity)
+  {
+    const std::size_t index = position(price);
+    if (isSame(index, price)) {
+      levels_[index].quantity_ = quantity;
+      return;
+    }
+    if (index == Depth) {
+      return;
+    }
+    // The last level falls out when full
+    const std::size_t last = (size_ < Depth) ? size_++ : Depth - 1;
+    std::copy_backward(levels_.begin() + index, levels_.begin() + last,
+                       levels_.begin() + last + 1);
+    levels_[index] = DepthLevel{price, quantity};
+  }
+
+  // Returns false when price wasn't cached
+  bool erase(const double price)
+  {
+    const std::size_t index = position(price);
+    if (!isSame(index, price)) {
+      return false;
+    }
+    std::copy(levels_.begin() + index + 1, levels_.begin() + size_,
+              levels_.begin() + index);
+    --size_;
+    return true;
+  }
+
+  // Refill the slot freed by an erase, price must be worse than the cache
+  void pushBack(const double price, const double quantity)
+  {
+    if (size_ < Depth) {
+      levels_[size_++] = DepthLevel{price, quantity};
+    }
+  }
+
+  // Copies every slot, count is the number of valid levels
+  std::size_t copyTo(levels_type& levels) const
+  {
+    levels = levels_;
+    return size_;
+  }
+
+  [[nodiscard]] const DepthLevel& operator[](const std::size_t index) const
+  {
+    return levels_[index];
+  }
+
+  [[nodiscard]] const DepthLevel& back() const { return levels_[size_ - 1]; }
+
+  [[nodiscard]] std::size_t size() const { return size_; }
+
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  [[nodiscard]] bool full() const { return size_ == Depth; }
+
+  void clear() { size_ = 0; }
+};
+}  // namespace gkp
@@ -0,0 +1,201 @@
+#pragma once
+// Header Guard
+
+#include "common.h"
+#include "spsc_ring.h"
+#include "telemetry_layout.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace gkp {
+
+struct PipelineOptions {
+  // Frames go through a ring to a processing thread instead of being parsed
+  // on the io_context thread
+  bool enabled{};
+  std::size_t ringSlots{1024};
+  // Parses on this many workers and applies in order per product, 0 parses
+  // on the processing thread
+  std::size_t parseWorkers{};
+  // Builds snapshot books on this many loader threads, 0 builds them where
+  // the frames are applied
+  std::size_t snapshotWorkers{};
+  // Core to pin each thread to, -1 leaves it to the scheduler
+  int networkCpu{-1};
+  int processingCpu{-1};
+};
+
+// Pins the calling thread, prints the error and returns false on failure
+inline bool
+pinThread(const int cpu)
+{
+  if (cpu < 0) {
+    return true;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(static_cast<std::size_t>(cpu), &set);
+  const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (error != 0) {
+    std::cerr << "pin to cpu " << cpu << ": " << std::strerror(error) << "\n";
+    return false;
+  }
+  return true;
+}
+
+// The network thread copies each frame into a preallocated slot and goes
+// back to the socket, a processing thread parses and applies the frames in
+// order. Slots keep their capacity, so only a frame larger than any before it
+// allocates.
+class FramePipeline {
+ public:
+  using frame_handler     = std::function<void(std::string_view)>;
+  using interval_callback = std::function<void()>;
+
+ private:
+  // Large enough for any l2update, snapshots grow their slot once
+  constexpr static std::size_t initialFrameSize{4096};
+  // Frames between clock reads for the interval callback
+  constexpr static std::size_t clockStride{256};
+
+  SpscRing<std::string> ring_;
+  PipelineOptions options_;
+  std::atomic<bool> running_{};
+  // Producer side, pushes that found the ring full and waited
+  std::atomic<uint64_t> fullWaits_{};
+  // Optional, never reset. Processing thread records the depth, network
+  // thread the full waits
+  TelemetryConnection* telemetry_{};
+
+  // Processing thread only, reset by printStats
+  struct DepthStats {
+    uint64_t frames_{};
+    uint64_t depthTotal_{};
+    std::size_t depthMax_{};
+  } depth_;
+
+  std::thread processor_;
+
+  void process(const frame_handler& handler, const Duration interval,
+               const interval_callback& onInterval)
+  {
+    pinThread(options_.processingCpu);
+    auto next = Clock::now() + interval;
+    std::size_t sinceClock{};
+    while (running_.load(std::memory_order_relaxed)) {
+      if (std::string* frame = ring_.front()) {
+        // Frames still queued behind this one
+        const std::size_t queued = ring_.size() - 1;
+        ++depth_.frames_;
+        depth_.depthTotal_ += queued;
+        depth_.depthMax_    = std::max(depth_.depthMax_, queued);
+        if (telemetry_ != nullptr) {
+          telemetry_->queueDepth_.record(queued);
+        }
+        handler(*frame);
+        ring_.pop();
+        if (++sinceClock < clockStride) {
+          continue;
+        }
+      }
+      sinceClock = 0;
+      if (onInterval && Clock::now() >= next) {
+        onInterval();
+        next += interval;
+      }
+      // Only gives the core up when another thread is waiting for it
+      std::this_thread::yield();
+    }
+  }
+
+ public:
+  explicit FramePipeline(const PipelineOptions& options)
+      : ring_(options.ringSlots, [] {
+          std::string slot;
+          slot.reserve(initialFrameSize);
+          return slot;
+        }()),
+        options_(options)
+  {
+  }
+
+  ~FramePipeline() { stop(); }
+
+  // Non-copyable & Non-moveable
+  FramePipeline(const FramePipeline&)            = delete;
+  FramePipeline& operator=(const FramePipeline&) = delete;
+  FramePipeline(FramePipeline&&)                 = delete;
+  FramePipeline& operator=(FramePipeline&&)      = delete;
+
+  // Before start
+  void setTelemetry(TelemetryConnection* telemetry) { telemetry_ = telemetry; }
+
+  // handler and onInterval run on the processing thread
+  void start(frame_handler handler, const Duration interval,
+             interval_callback onInterval)
+  {
+    running_.store(true, std::memory_order_relaxed);
+    processor_ = std::thread{[this, handler = std::move(handler), interval,
+                              onInterval = std::move(onInterval)] {
+      process(handler, interval, onInterval);
+    }};
+  }
+
+  void stop()
+  {
+    running_.store(false, std::memory_order_relaxed);
+    if (processor_.joinable()) {
+      processor_.join();
+    }
+  }
+
+  // Network thread. Waits for a slot when processing is a whole ring
+  // behind, dropping a frame would corrupt the book
+  void push(const std::string_view frame)
+  {
+    std::string* slot = ring_.claim();
+    if (slot == nullptr) {
+      fullWaits_.fetch_add(1, std::memory_order_relaxed);
+      if (telemetry_ != nullptr) {
+        bumpCounter(telemetry_->fullWaits_);
+      }
+      while ((slot = ring_.claim()) == nullptr) {
+        std::this_thread::yield();
+      }
+    }
+    // std::string keeps the null after the frame that the parser needs
+    slot->assign(frame);
+    ring_.push();
+  }
+
+  // Processing thread, from the interval callback
+  void printStats()
+  {
+    std::cout << "\nPipeline Queue Depth:\n";
+    std::cout << "Frames:     " << depth_.frames_ << '\n';
+    std::cout << "Mean:       "
+              << ((depth_.frames_ == 0)
+                      ? 0.0
+                      : static_cast<double>(depth_.depthTotal_)
+                            / static_cast<double>(depth_.frames_))
+              << '\n';
+    std::cout << "Max:        " << depth_.depthMax_ << '\n';
+    std::cout << "Capacity:   " << ring_.capacity() << '\n';
+    std::cout << "Full Waits: "
+              << fullWaits_.exchange(0, std::memory_order_relaxed) << '\n';
+    depth_ = DepthStats{};
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,181 @@
+#pragma once
+// Header Guard
+
+#include "message_types.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace gkp {
+
+// Reads l2update and snapshot frames straight into the message structs,
+// without a generic document. Strings are found with a SIMD search for the
+// closing quote, and rows of strings are walked in place. Anything outside
+// the compact shape Coinbase sends, such as whitespace, escapes, nested
+// objects or a non string value, fails the scan and the caller falls back to
+// glaze.
+class FrameScanner {
+ private:
+  const char* pos_;
+  const char* end_;
+
+  // First '"' or '\\' at or after pos_, end_ when there's none
+  [[nodiscard]] const char* findQuote() const
+  {
+    const char* it = pos_;
+#if defined(__SSE2__)
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; end_ - it >= 16; it += 16) {
+      const __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+      const int mask = _mm_movemask_epi8(
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                       _mm_cmpeq_epi8(chunk, backslash)));
+      if (mask != 0) {
+        return it + __builtin_ctz(static_cast<unsigned>(mask));
+      }
+    }
+#endif
+    for (; it != end_; ++it) {
+      if (*it == '"' || *it == '\\') {
+        return it;
+      }
+    }
+    return end_;
+  }
+
+  bool expect(const char character)
+  {
+    if (pos_ == end_ || *pos_ != character) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  // Escaped strings are left to glaze
+  bool readString(std::string_view& value)
+  {
+    if (!expect('"')) {
+      return false;
+    }
+    const char* close = findQuote();
+    if (close == end_ || *close != '"') {
+      return false;
+    }
+    value = std::string_view{pos_, static_cast<std::size_t>(close - pos_)};
+    pos_  = close + 1;
+    return true;
+  }
+
+  // [["a","b"],["c","d"]] with Width strings per row
+  template <std::size_t Width>
+  bool readRows(std::vector<std::array<std::string_view, Width>>& rows)
+  {
+    rows.clear();
+    if (!expect('[')) {
+      return false;
+    }
+    if (expect(']')) {
+      return true;
+    }
+    do {
+      if (!expect('[')) {
+        return false;
+      }
+      auto& row = rows.emplace_back();
+      for (std::size_t i{}; i < Width; ++i) {
+        if ((i != 0 && !expect(',')) || !readString(row[i])) {
+          return false;
+        }
+      }
+      if (!expect(']')) {
+        return false;
+      }
+    } while (expect(','));
+    return expect(']');
+  }
+
+  // Calls readValue for each key, it reads the value or returns false
+  template <typename Function>
+  bool readObject(Function&& readValue)
+  {
+    if (!expect('{')) {
+      return false;
+    }
+    if (expect('}')) {
+      return true;
+    }
+    do {
+      std::string_view key;
+      if (!readString(key) || !expect(':') || !readValue(key)) {
+        return false;
+      }
+    } while (expect(','));
+    return expect('}');
+  }
+
+  // Keys the schema doesn't use, only string values are skipped
+  bool skipString()
+  {
+    std::string_view ignored;
+    return readString(ignored);
+  }
+
+ public:
+  explicit FrameScanner(const std::string_view json)
+      : pos_(json.data()), end_(json.data() + json.size())
+  {
+  }
+
+  // False on any shape it doesn't know, msg is then partly written
+  [[nodiscard]] bool scan(L2UpdateMsg& msg)
+  {
+    msg.changes.clear();
+    msg.time = {};
+    return readObject([this, &msg](const std::string_view key) {
+      if (key == "changes") {
+        return readRows(msg.changes);
+      }
+      if (key == "type") {
+        return readString(msg.type);
+      }
+      if (key == "product_id") {
+        return readString(msg.product_id);
+      }
+      if (key == "time") {
+        return readString(msg.time);
+      }
+      return skipString();
+    });
+  }
+
+  [[nodiscard]] bool scan(SnapshotMsg& msg)
+  {
+    msg.bids.clear();
+    msg.asks.clear();
+    return readObject([this, &msg](const std::string_view key) {
+      if (key == "bids") {
+        return readRows(msg.bids);
+      }
+      if (key == "asks") {
+        return readRows(msg.asks);
+      }
+      if (key == "type") {
+        return readString(msg.type);
+      }
+      if (key == "product_id") {
+        return readString(msg.product_id);
+      }
+      return skipString();
+    });
+  }
+};
+}  // namespace gkp
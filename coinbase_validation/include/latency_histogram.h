@@ -0,0 +1,137 @@
+#pragma once
+// Header Guard
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+namespace gkp {
+
+// Fixed memory log-linear histogram. Values below subCount get a bucket each,
+// every power of two above that is split into subCount linear buckets, so a
+// bucket is within 1/subCount of its values. Recording is a bit scan and an
+// increment, percentiles walk the buckets instead of sorting samples.
+class LatencyHistogram {
+ private:
+  constexpr static uint32_t subBits{4};
+  constexpr static uint64_t subCount{uint64_t{1} << subBits};
+  // Values from 2^maxBits up land in the last bucket
+  constexpr static uint32_t maxBits{40};
+
+ public:
+  constexpr static std::size_t bucketCount{
+      ((maxBits - subBits) + 1) * subCount};
+  using bucket_counts = std::array<uint64_t, bucketCount>;
+
+ private:
+  bucket_counts counts_{};
+  uint64_t count_{};
+  uint64_t sum_{};
+  uint64_t min_{std::numeric_limits<uint64_t>::max()};
+  uint64_t max_{};
+
+ public:
+  // Shared with the telemetry segment, which keeps its own counts
+  [[nodiscard]] static std::size_t bucketOf(const uint64_t value)
+  {
+    if (value < subCount) {
+      return static_cast<std::size_t>(value);
+    }
+    const auto msb = static_cast<uint32_t>(std::bit_width(value) - 1);
+    if (msb >= maxBits) {
+      return bucketCount - 1;
+    }
+    const uint32_t shift = msb - subBits;
+    return ((shift + 1) * subCount) + ((value >> shift) - subCount);
+  }
+
+  // Largest value that lands in bucket
+  [[nodiscard]] static uint64_t upperBound(const std::size_t bucket)
+  {
+    if (bucket < subCount) {
+      return bucket;
+    }
+    const uint64_t shift = (bucket / subCount) - 1;
+    const uint64_t sub   = (bucket % subCount) + subCount;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  // Upper bound of the bucket holding the quantile of total values
+  [[nodiscard]] static uint64_t percentileOf(const bucket_counts& counts,
+                                             const uint64_t total,
+                                             const double quantile)
+  {
+    if (total == 0) {
+      return 0;
+    }
+    const auto rank =
+        static_cast<uint64_t>(quantile * static_cast<double>(total - 1));
+    uint64_t seen{};
+    for (std::size_t i{}; i < bucketCount; ++i) {
+      seen += counts[i];
+      if (seen > rank) {
+        return upperBound(i);
+      }
+    }
+    return upperBound(bucketCount - 1);
+  }
+
+  void record(const uint64_t value)
+  {
+    ++counts_[bucketOf(value)];
+    ++count_;
+    sum_ += value;
+    min_  = std::min(min_, value);
+    max_  = std::max(max_, value);
+  }
+
+  void merge(const LatencyHistogram& other)
+  {
+    for (std::size_t i{}; i < bucketCount; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_   += other.sum_;
+    min_    = std::min(min_, other.min_);
+    max_    = std::max(max_, other.max_);
+  }
+
+  void reset() { *this = LatencyHistogram{}; }
+
+  [[nodiscard]] uint64_t count() const { return count_; }
+
+  [[nodiscard]] uint64_t min() const { return (count_ == 0) ? 0 : min_; }
+
+  [[nodiscard]] uint64_t max() const { return max_; }
+
+  [[nodiscard]] double mean() const
+  {
+    return (count_ == 0)
+               ? 0.0
+               : static_cast<double>(sum_) / static_cast<double>(count_);
+  }
+
+  // Upper bound of the bucket holding the quantile, never above max()
+  [[nodiscard]] uint64_t percentile(const double quantile) const
+  {
+    return std::min(percentileOf(counts_, count_, quantile), max_);
+  }
+
+  // Values are multiplied by scale, e.g. nanoseconds per TSC tick
+  void print(const double scale) const
+  {
+    const auto scaled = [scale](const uint64_t value) {
+      return static_cast<uint64_t>(static_cast<double>(value) * scale);
+    };
+    std::cout << "Count:     " << count_ << "\n";
+    std::cout << "Min (ns):  " << scaled(min()) << '\n';
+    std::cout << "Mean (ns): " << mean() * scale << '\n';
+    std::cout << "99% (ns):  " << scaled(percentile(0.99)) << '\n';
+    std::cout << "Max (ns):  " << scaled(max()) << '\n';
+  }
+};
+}  // namespace gkp
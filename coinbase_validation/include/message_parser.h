@@ -1,19 +1,35 @@
 #pragma once
 // Header Guard
 
+#include "book_event.h"
+#include "broadcast_ring.h"
 #include "common.h"
+#include "decimal_parser.h"
 #include "dro/oa-hashmap.hpp"
 #include "fast-double-parser/fast_double_parser.h"
+#include "frame_pipeline.h"
+#include "frame_scanner.h"
 #include "glaze/glaze.hpp"
+#include "latency_histogram.h"
 #include "message_types.h"
 #include "orderbook.h"
+#include "parallel_parser.h"
+#include "shm_publisher.h"
+#include "snapshot_loader.h"
+#include "telemetry_publisher.h"
+#include "tsc_clock.h"
 #include "websocket.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace ssl = boost::asio::ssl;
 
@@ -21,26 +37,147 @@ namespace gkp {
 
 class MessageParser {
  private:
-  using side_type = std::vector<std::array<std::string, 2>>;
+  using event_ring = BroadcastRing<BookEvent>;
+  using bbo_ring   = BroadcastRing<BboEvent>;
+  using parse_pool = ParallelParser<ParsedFrame>;
+
+  constexpr static std::string_view typeKey{R"("type":")"};
+  constexpr static std::string_view productKey{R"("product_id":")"};
 
   SubscribeMsg subMessage_;
+  // Reused for every frame parsed on this thread, its vectors keep their
+  // capacity
+  ParsedFrame frame_;
+  OrderbookOptions bookOptions_;
   std::vector<LimitOrderBook> orderbooksStorage_;
-  dro::HashMap<std::string, uint16_t> productOrderbookID_{""};
-
-  dro::HashMap<std::string, std::vector<std::size_t>> orderbookTimes_{""};
-  dro::HashMap<std::string, std::size_t> snapshotTotals_{""};
-  dro::HashMap<std::string, std::vector<std::size_t>> l2updateTotals_{""};
+  // Subscription index of each book, same order as orderbooksStorage_
+  std::vector<uint16_t> bookProductIndex_;
+  // One per subscribed product, same order, with OrderbookOptions::publishTop.
+  // They point into the shared memory segment or into ownedTops_
+  std::vector<LimitOrderBook::top_seqlock*> publishedTops_;
+  std::vector<std::unique_ptr<LimitOrderBook::top_seqlock>> ownedTops_;
+  ShmPublisher shmPublisher_;
+  // With OrderbookOptions::eventCapacity
+  std::unique_ptr<event_ring> bookEvents_;
+  // With OrderbookOptions::bboCapacity, lastBbo_ is the last one sent per book
+  std::unique_ptr<bbo_ring> bboEvents_;
+  std::vector<Bbo> lastBbo_;
+  // Book of each subscribed product, noBook until its first snapshot. Frames
+  // find their book by subscription index, no string key per frame
+  constexpr static uint16_t noBook{std::numeric_limits<uint16_t>::max()};
+  std::vector<uint16_t> subscriptionBook_;
+  // Subscription index of each product, the keys view subMessage_'s strings.
+  // Looked up once per frame, read only after construction
+  dro::HashMap<std::string_view, uint16_t> productIndexes_{std::string_view{}};
+
+  // Latency statistics per book, same order as orderbooksStorage_. In TSC
+  // ticks, converted when printed, and reset by each print
+  struct BookStats {
+    LatencyHistogram l2update_;
+    LatencyHistogram orderbookUpdate_;
+    // Last snapshot since the print, 0 when there was none
+    uint64_t snapshotTicks_{};
+  };
+  std::vector<BookStats> bookStats_;
+  LatencyHistogram connectionL2_;
+  TscClock tsc_;
+  // With OrderbookOptions::telemetryName, the same statistics never reset,
+  // for other processes. The pointers are nullptr without a segment
+  TelemetryPublisher telemetry_;
+  TelemetryConnection* connectionTelemetry_{};
+  std::vector<TelemetryProduct*> bookTelemetry_;
+  // Frames handled since the last print, for the throughput report
+  std::size_t frameCount_{};
+  Clock::time_point statsStart_{Clock::now()};
+  // Startup metric, from construction until every subscribed product has a
+  // book, zero until then
+  const Clock::time_point createdAt_{Clock::now()};
+  Duration allBooksReady_{};
+
+  // With PipelineOptions::snapshotWorkers. While a product's snapshot is
+  // loading its updates are held back, then replayed onto the loaded book.
+  // One per subscribed product, same order
+  struct PendingBook {
+    // Bumped by every snapshot, only the latest one's book is installed
+    uint64_t generation_{};
+    bool loading_{};
+    std::vector<ParsedFrame> held_;
+  };
+  std::vector<PendingBook> pendingBooks_;
+  std::size_t snapshotsInFlight_{};
+  std::vector<SnapshotLoader::Loaded> loaded_;
 
   std::shared_ptr<Websocket> websocket_ = nullptr;
   io_context& ioc_;
   ssl_context& ctx_;
+  // Processing thread only, a restart is posted once until the next snapshot
+  bool restartPending_{};
+  // Last, their threads are joined before the rest goes away. The pipelines
+  // submit to the loader, so it goes after them
+  std::unique_ptr<SnapshotLoader> snapshotLoader_;
+  std::unique_ptr<FramePipeline> pipeline_;
+  std::unique_ptr<parse_pool> parsePool_;
 
  public:
   explicit MessageParser(const SubscribeMsg& sub, io_context& ioc,
-                         ssl_context& ctx)
-      : subMessage_(sub), ioc_(ioc), ctx_(ctx)
+                         ssl_context& ctx,
+                         const OrderbookOptions& bookOptions = {},
+                         const PipelineOptions& pipelineOptions = {})
+      : subMessage_(sub), bookOptions_(bookOptions), ioc_(ioc), ctx_(ctx)
   {
-    productOrderbookID_.reserve(sub.product_ids.size());
+    subscriptionBook_.assign(sub.product_ids.size(), noBook);
+    productIndexes_.reserve(subMessage_.product_ids.size());
+    for (std::size_t i{}; i < subMessage_.product_ids.size(); ++i) {
+      productIndexes_.emplace(subMessage_.product_ids[i],
+                              static_cast<uint16_t>(i));
+    }
+    pendingBooks_.resize(sub.product_ids.size());
+    if (!bookOptions_.telemetryName.empty()
+        && telemetry_.open(bookOptions_.telemetryName, sub.product_ids,
+                           tsc_.nanosPerTick()))
+    {
+      connectionTelemetry_ = telemetry_.connection();
+    }
+    if (pipelineOptions.snapshotWorkers != 0) {
+      snapshotLoader_ = std::make_unique<SnapshotLoader>(
+          bookOptions_,
+          [](std::string_view json, ParsedFrame& frame) {
+            parseFrame(json, frame);
+          },
+          pipelineOptions.snapshotWorkers);
+    }
+    // One lane per subscribed product and one for every other frame
+    if (pipelineOptions.parseWorkers != 0) {
+      parsePool_ = std::make_unique<parse_pool>(
+          pipelineOptions, pipelineOptions.parseWorkers,
+          sub.product_ids.size() + 1);
+      parsePool_->setTelemetry(connectionTelemetry_);
+    } else if (pipelineOptions.enabled) {
+      pipeline_ = std::make_unique<FramePipeline>(pipelineOptions);
+      pipeline_->setTelemetry(connectionTelemetry_);
+    }
+    if (bookOptions_.eventCapacity != 0) {
+      bookEvents_ = std::make_unique<event_ring>(bookOptions_.eventCapacity);
+    }
+    if (bookOptions_.bboCapacity != 0) {
+      bboEvents_ = std::make_unique<bbo_ring>(bookOptions_.bboCapacity);
+    }
+    // Created up front so readers can look them up before the first snapshot
+    if (!bookOptions_.shmName.empty()
+        && shmPublisher_.open(bookOptions_.shmName, sub.product_ids))
+    {
+      for (std::size_t i{}; i < sub.product_ids.size(); ++i) {
+        publishedTops_.push_back(shmPublisher_.top(i));
+      }
+      return;
+    }
+    // Without a segment the tops are still published in process
+    if (bookOptions_.publishTop || !bookOptions_.shmName.empty()) {
+      for (std::size_t i{}; i < sub.product_ids.size(); ++i) {
+        ownedTops_.push_back(std::make_unique<LimitOrderBook::top_seqlock>());
+        publishedTops_.push_back(ownedTops_.back().get());
+      }
+    }
   }
 
   ~MessageParser()                               = default;
@@ -56,206 +193,615 @@ class MessageParser {
 
     websocket_          = std::make_shared<Websocket>(
         ioc_, ctx_, message,
-        [this](std::string& json) { level2EventHandler(json); });
+        [this](std::string_view json) {
+          if (parsePool_) {
+            parsePool_->push(json, [this](const std::string_view frame,
+                                          ParsedFrame& parsed) {
+              parsed.received_      = Clock::now();
+              parsed.receivedTicks_ = TscClock::now();
+              parsed.productIndex_ =
+                  subscriptionIndex(peekString(frame, productKey));
+              return parsed.productIndex_;
+            });
+            return;
+          }
+          if (pipeline_) {
+            pipeline_->push(json);
+            return;
+          }
+          level2EventHandler(json);
+        });
     websocket_->run();
   }
 
-  void level2EventHandler(const std::string& json)
+  // With PipelineOptions::enabled or parseWorkers, starts the thread that
+  // applies the frames, and the parse workers. onInterval runs on the
+  // applying thread every interval, print from there
+  void startProcessing(const Duration interval,
+                       FramePipeline::interval_callback onInterval)
   {
-    struct MsgType {
-      std::string type;
-    } msg;
-
-    if (!glz::read_json<MsgType>(msg, json)) {
-      return;  // Error handling omitted
+    if (parsePool_) {
+      parsePool_->start(
+          [loadSnapshots = snapshotLoader_ != nullptr](std::string_view json,
+                                                       ParsedFrame& frame) {
+            parseFrame(json, frame, !loadSnapshots);
+          },
+          [this](ParsedFrame& frame) { applyFrame(frame); }, interval,
+          std::move(onInterval));
+      return;
     }
-
-    if (msg.type == "l2update") {
-      if (!parseL2Update(json)) {
-        return;  // Error handling omitted
-      }
-    } else if (msg.type == "snapshot") {
-      if (!parseSnapshot(json)) {
-        return;  // Error handling omitted
-      }
-    } else if (msg.type == "subscriptions") [[unlikely]] {
-      if (!MessageParser::validateSubscribeRecv(json)) {
-        return;  // Error handling omitted
-      }
-    } else {
-      return;  // Error Fallthrough
+    if (pipeline_) {
+      pipeline_->start(
+          [this](std::string_view json) { level2EventHandler(json); },
+          interval, std::move(onInterval));
     }
   }
 
+  [[nodiscard]] bool pipelined() const
+  {
+    return pipeline_ != nullptr || parsePool_ != nullptr;
+  }
+
+  // Top of book for reader threads, nullptr when the product isn't
+  // subscribed or publishTop is off. Safe to call from any thread
+  [[nodiscard]] const LimitOrderBook::top_seqlock* publishedTop(
+      const std::string& productID) const
+  {
+    const std::size_t index = subscriptionIndex(productID);
+    return (index < publishedTops_.size()) ? publishedTops_[index] : nullptr;
+  }
+
+  // Book changes for consumer threads, each reads them through its own
+  // event_ring::Consumer. nullptr when eventCapacity is 0
+  [[nodiscard]] const event_ring* bookEvents() const
+  {
+    return bookEvents_.get();
+  }
+
+  // Best bid and offer changes only, nullptr when bboCapacity is 0
+  [[nodiscard]] const bbo_ring* bboEvents() const { return bboEvents_.get(); }
+
+  // json must be followed by a null in memory, Websocket guarantees it
+  void level2EventHandler(const std::string_view json)
+  {
+    frame_.received_      = Clock::now();
+    frame_.receivedTicks_ = TscClock::now();
+    parseFrame(json, frame_, !snapshotLoader_);
+    frame_.productIndex_ = subscriptionIndex(frame_.productId_);
+    applyFrame(frame_);
+  }
+
   void printOrderbookWithStats(const uint16_t depth)
   {
+    collectSnapshots();
     for (const auto& orderbook : orderbooksStorage_) {
       orderbook.printLevels(depth);
     }
 
     std::cout << "\nStatistics:";
-
-    if (!snapshotTotals_.empty()) {
+    const double scale = tsc_.nanosPerTick();
+
+    const auto anyBook = [this](const auto& has) {
+      return std::any_of(bookStats_.begin(), bookStats_.end(), has);
+    };
+    if (anyBook([](const BookStats& stats) {
+          return stats.snapshotTicks_ != 0;
+        }))
+    {
       std::cout << "\nTotal Snapshot Processing Time:\n";
     }
+    for (std::size_t book{}; book < bookStats_.size(); ++book) {
+      if (bookStats_[book].snapshotTicks_ != 0) {
+        std::cout << orderbooksStorage_[book].productID() << " - Time: "
+                  << tsc_.toNanos(bookStats_[book].snapshotTicks_) << " ns\n";
+      }
+    }
 
-    for (const auto& snapTime : snapshotTotals_) {
-      std::cout << snapTime.first << " - Time: " << snapTime.second << " ns\n";
+    if (anyBook([](const BookStats& stats) {
+          return stats.l2update_.count() != 0;
+        }))
+    {
+      std::cout << "\nL2 Message Processing Time:";
+    }
+    for (std::size_t book{}; book < bookStats_.size(); ++book) {
+      if (bookStats_[book].l2update_.count() != 0) {
+        std::cout << '\n' << orderbooksStorage_[book].productID() << '\n';
+        bookStats_[book].l2update_.print(scale);
+      }
     }
 
-    if (!l2updateTotals_.empty()) {
-    std::cout << "\nL2 Message Processing Time:";
+    if (anyBook([](const BookStats& stats) {
+          return stats.orderbookUpdate_.count() != 0;
+        }))
+    {
+      std::cout << "\nOrderbook Update Time:";
     }
-    for (auto& l2update : l2updateTotals_) {
-      std::cout << '\n' << l2update.first << '\n';
-      MessageParser::analyzeData(l2update.second);
+    for (std::size_t book{}; book < bookStats_.size(); ++book) {
+      if (bookStats_[book].orderbookUpdate_.count() != 0) {
+        std::cout << '\n' << orderbooksStorage_[book].productID() << '\n';
+        bookStats_[book].orderbookUpdate_.print(scale);
+      }
     }
 
-    if (!orderbookTimes_.empty()) {
-    std::cout << "\nOrderbook Update Time:";
+    printThroughput();
+    printStartup();
+
+    if (pipeline_) {
+      pipeline_->printStats();
     }
-    for (auto& orderbookTime : orderbookTimes_) {
-      std::cout << '\n' << orderbookTime.first << '\n';
-      MessageParser::analyzeData(orderbookTime.second);
+    if (parsePool_) {
+      parsePool_->printStats();
     }
 
-    snapshotTotals_.clear();
-    l2updateTotals_.clear();
-    orderbookTimes_.clear();
+    for (auto& stats : bookStats_) {
+      stats.l2update_.reset();
+      stats.orderbookUpdate_.reset();
+      stats.snapshotTicks_ = 0;
+    }
   }
 
  private:
+  // Reads a string value, key being its quoted name with the colon and the
+  // opening quote, without parsing the message. Coinbase sends compact JSON
+  // with type and product_id as the first keys, so the search stops within
+  // the first few bytes
+  [[nodiscard]] static std::string_view peekString(const std::string_view json,
+                                                   const std::string_view key)
+  {
+    const std::size_t found = json.find(key);
+    if (found == std::string_view::npos) {
+      return {};
+    }
+    const std::size_t start = found + key.size();
+    const std::size_t end   = json.find('"', start);
+    if (end == std::string_view::npos) {
+      return {};
+    }
+    return json.substr(start, end - start);
+  }
 
-  [[nodiscard]] bool parseSnapshot(const std::string& json)
+  // Feed decimals go through the fixed point parser, it returns the same
+  // double. The view is followed by the closing quote, which stops
+  // fast_double_parser on the rare string it has to take
+  [[nodiscard]] static bool parseNumber(const std::string_view text,
+                                        double& value)
   {
-    auto startSnap = std::chrono::high_resolution_clock::now();
-    bool success{};
+    return DecimalParser::parseDouble(
+        text, value, [](const std::string_view number, double& result) {
+          return fast_double_parser::parse_number(number.data(), &result)
+                 != nullptr;
+        });
+  }
 
-    SnapshotMsg snapshot;
-    success                 = glz::read_json<SnapshotMsg>(snapshot, json);
+  // product_ids.size() when the product isn't subscribed. Safe to call from
+  // any thread
+  [[nodiscard]] std::size_t subscriptionIndex(
+      const std::string_view productID) const
+  {
+    const auto iter = productIndexes_.find(productID);
+    return (iter == productIndexes_.end()) ? subMessage_.product_ids.size()
+                                           : iter->second;
+  }
 
-    std::string& product_id = snapshot.product_id;
-    auto iter               = productOrderbookID_.find(product_id);
-    // If the product doesn't exist, add to hashmap and build book
-    if (iter == productOrderbookID_.end()) {
-      iter = productOrderbookID_.emplace(product_id, orderbooksStorage_.size())
-                 .first;
-      orderbooksStorage_.emplace_back(product_id);
+  // Parses json into frame, numbers included, so each frame is parsed once
+  // into the message of its type. Touches nothing but frame, the parse
+  // workers run it in parallel. Without parseSnapshots a snapshot only gets
+  // its product, the loader parses it. json must be followed by a null in
+  // memory
+  static void parseFrame(const std::string_view json, ParsedFrame& frame,
+                         const bool parseSnapshots = true)
+  {
+    frame.levels_.clear();
+    frame.text_                 = json;
+    frame.productId_            = {};
+    const std::string_view type = peekString(json, typeKey);
+    if (type == "l2update") {
+      frame.type_ = FrameType::L2Update;
+      // glaze handles whatever the scanner doesn't know
+      if (!FrameScanner{json}.scan(frame.l2update_)
+          && glz::read_json<L2UpdateMsg>(frame.l2update_, json))
+      {
+        // Not applied, whatever index it was tagged with
+        frame.type_ = FrameType::Other;
+        return;  // Error handling omitted
+      }
+      frame.productId_ = frame.l2update_.product_id;
+      for (const auto& change : frame.l2update_.changes) {
+        if (!appendLevel(frame, change[0][0], change[1], change[2])) {
+          frame.type_ = FrameType::Malformed;
+          return;
+        }
+      }
+    } else if (type == "snapshot") {
+      frame.type_ = FrameType::Snapshot;
+      if (!parseSnapshots) {
+        frame.productId_ = peekString(json, productKey);
+        return;
+      }
+      if (!FrameScanner{json}.scan(frame.snapshot_)
+          && glz::read_json<SnapshotMsg>(frame.snapshot_, json))
+      {
+        frame.type_ = FrameType::Other;
+        return;  // Error handling omitted
+      }
+      frame.productId_ = frame.snapshot_.product_id;
+      for (const auto& bid : frame.snapshot_.bids) {
+        if (!appendLevel(frame, 'b', bid[0], bid[1])) {
+          frame.type_ = FrameType::Malformed;
+          return;
+        }
+      }
+      for (const auto& ask : frame.snapshot_.asks) {
+        if (!appendLevel(frame, 's', ask[0], ask[1])) {
+          frame.type_ = FrameType::Malformed;
+          return;
+        }
+      }
+    } else if (type == "subscriptions") [[unlikely]] {
+      frame.type_ = FrameType::Subscriptions;
+      if (!MessageParser::validateSubscribeRecv(json)) {
+        return;  // Error handling omitted
+      }
+    } else {
+      frame.type_ = FrameType::Other;  // Error Fallthrough
     }
-    uint16_t bookID = iter->second;
-    auto& orderbook = orderbooksStorage_[bookID];
-    orderbook.clearBook();
+  }
 
-    updateOrderbookSnap(product_id, true, snapshot.bids, orderbook);
-    updateOrderbookSnap(product_id, false, snapshot.asks, orderbook);
+  // False when either number doesn't parse, the level is then unusable
+  [[nodiscard]] static bool appendLevel(ParsedFrame& frame, const char side,
+                                        const std::string_view price,
+                                        const std::string_view quantity)
+  {
+    ParsedLevel& level = frame.levels_.emplace_back();
+    level.side_        = side;
+    return parseNumber(price, level.price_)
+           && parseNumber(quantity, level.quantity_);
+  }
 
-    auto endSnap = std::chrono::high_resolution_clock::now();
-    snapshotTotals_[product_id] =
-        std::chrono::duration_cast<std::chrono::nanoseconds>(endSnap
-                                                             - startSnap)
-            .count();
-    return success;
+  // Runs where the books live, the frame thread or the processing thread
+  void applyFrame(const ParsedFrame& frame)
+  {
+    ++frameCount_;
+    if (connectionTelemetry_ != nullptr) {
+      bumpCounter(connectionTelemetry_->frames_);
+    }
+    if (snapshotsInFlight_ != 0) {
+      collectSnapshots();
+    }
+    if (frame.type_ != FrameType::L2Update
+        && frame.type_ != FrameType::Snapshot
+        && frame.type_ != FrameType::Malformed)
+    {
+      return;
+    }
+    // Coinbase only sends the subscribed products
+    const std::size_t index = frame.productIndex_;
+    if (index == subMessage_.product_ids.size()) {
+      return;
+    }
+    // Applying the rest of it, or skipping it, would leave the book wrong
+    if (frame.type_ == FrameType::Malformed) {
+      requestRestart();
+      return;
+    }
+    if (frame.type_ == FrameType::L2Update) {
+      applyL2Update(frame, index);
+    } else if (snapshotLoader_) {
+      loadSnapshot(frame, index);
+    } else {
+      applySnapshot(frame, index);
+    }
   }
 
-  void updateOrderbookSnap(const std::string& product_id, const bool buySell,
-                           const side_type& side, auto& orderbook)
+  // Finds the subscribed product's book, creating it on its first snapshot
+  uint16_t bookFor(const std::size_t index)
   {
-    std::vector<std::size_t>& orderbookTimes = orderbookTimes_[product_id];
+    if (subscriptionBook_[index] != noBook) {
+      return subscriptionBook_[index];
+    }
+    const auto bookID        = static_cast<uint16_t>(orderbooksStorage_.size());
+    subscriptionBook_[index] = bookID;
+    orderbooksStorage_.emplace_back(subMessage_.product_ids[index],
+                                    bookOptions_);
+    bookProductIndex_.push_back(static_cast<uint16_t>(index));
+    bookStats_.emplace_back();
+    bookTelemetry_.push_back(telemetry_.isOpen() ? telemetry_.product(index)
+                                                 : nullptr);
+    lastBbo_.emplace_back();
+    if (index < publishedTops_.size()) {
+      orderbooksStorage_.back().setPublisher(publishedTops_[index]);
+    }
+    return bookID;
+  }
 
-    double price{};
-    double quantity{};
-    for (const auto& level : side) {
-      // Assume Successful parse
-      const char* valid =
-          fast_double_parser::parse_number(level[0].data(), &price);
-      valid      = fast_double_parser::parse_number(level[1].data(), &quantity);
+  void applySnapshot(const ParsedFrame& frame, const std::size_t index)
+  {
+    const uint16_t bookID = bookFor(index);
+    auto& orderbook       = orderbooksStorage_[bookID];
+    orderbook.clearBook();
 
-      auto start = std::chrono::high_resolution_clock::now();
-      orderbook.buildSides(buySell, price, quantity);
-      auto end = std::chrono::high_resolution_clock::now();
+    updateOrderbookSnap(bookID, frame.levels_);
+    finishSnapshot(bookID, frame.received_, frame.receivedTicks_);
+  }
 
-      orderbookTimes.emplace_back(
-          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-              .count());
-    }
+  // Hands the snapshot to the loader, the product's updates are held until
+  // its book comes back
+  void loadSnapshot(const ParsedFrame& frame, const std::size_t index)
+  {
+    PendingBook& pending = pendingBooks_[index];
+    ++pending.generation_;
+    pending.loading_ = true;
+    // The new snapshot supersedes whatever was held for the previous one
+    pending.held_.clear();
+    ++snapshotsInFlight_;
+    snapshotLoader_->submit(frame.text_, frame.productId_, pending.generation_,
+                            frame.received_, frame.receivedTicks_);
+  }
+
+  // Copies what applyL2Update reads, the product is the pending book's
+  static void holdUpdate(std::vector<ParsedFrame>& held,
+                         const ParsedFrame& frame)
+  {
+    ParsedFrame& copy = held.emplace_back();
+    copy.type_          = frame.type_;
+    copy.received_      = frame.received_;
+    copy.receivedTicks_ = frame.receivedTicks_;
+    copy.levels_        = frame.levels_;
   }
 
-  [[nodiscard]] bool parseL2Update(const std::string& json)
+  // Installs the books the loader finished and replays what was held for
+  // them. Called before each frame while snapshots are loading
+  void collectSnapshots()
   {
-    auto startL2 = std::chrono::high_resolution_clock::now();
-    bool success{};
+    if (!snapshotLoader_) {
+      return;
+    }
+    snapshotLoader_->takeLoaded(loaded_);
+    for (auto& loaded : loaded_) {
+      --snapshotsInFlight_;
+      const std::size_t index = subscriptionIndex(loaded.productID_);
+      PendingBook& pending    = pendingBooks_[index];
+      if (loaded.generation_ != pending.generation_) {
+        continue;
+      }
+      // The held updates have no base, start over from fresh snapshots
+      if (!loaded.parsed_) {
+        pending.loading_ = false;
+        pending.held_.clear();
+        requestRestart();
+        continue;
+      }
+      const uint16_t bookID = bookFor(index);
+      orderbooksStorage_[bookID].adoptLevels(std::move(loaded.book_));
+      finishSnapshot(bookID, loaded.received_, loaded.receivedTicks_);
+      pending.loading_ = false;
+      for (const auto& held : pending.held_) {
+        applyL2Update(held, index);
+      }
+      pending.held_.clear();
+    }
+  }
 
-    L2UpdateMsg l2update;
-    success                 = glz::read_json<L2UpdateMsg>(l2update, json);
+  // A book was just rebuilt from a snapshot
+  void finishSnapshot(const uint16_t bookID, const auto received,
+                      const uint64_t receivedTicks)
+  {
+    auto& orderbook = orderbooksStorage_[bookID];
+    restartPending_ = false;
+    orderbook.publishTop();
+    publishEvent(BookEvent{.productIndex_ = bookProductIndex_[bookID],
+                           .type_ = BookEventType::Snapshot,
+                           .sequence_ = orderbook.updateCount()},
+                 received);
+    publishBbo(bookID, received);
+
+    const uint64_t snapshotTicks      = TscClock::now() - receivedTicks;
+    bookStats_[bookID].snapshotTicks_ = snapshotTicks;
+    if (TelemetryProduct* telemetry = bookTelemetry_[bookID]) {
+      bumpCounter(telemetry->snapshots_);
+      telemetry->snapshotTicks_.store(snapshotTicks,
+                                      std::memory_order_relaxed);
+    }
+    if (allBooksReady_ == Duration::zero()
+        && orderbooksStorage_.size() == subMessage_.product_ids.size())
+    {
+      allBooksReady_ = Clock::now() - createdAt_;
+      if (connectionTelemetry_ != nullptr) {
+        connectionTelemetry_->allBooksReadyNanos_.store(
+            static_cast<uint64_t>(allBooksReady_.count()),
+            std::memory_order_relaxed);
+      }
+    }
+  }
 
-    std::string& product_id = l2update.product_id;
-    auto iter               = productOrderbookID_.find(product_id);
-    if (iter == productOrderbookID_.end()) {
-      return false; 
+  void updateOrderbookSnap(const uint16_t bookID,
+                           const std::vector<ParsedLevel>& levels)
+  {
+    auto& orderbook                   = orderbooksStorage_[bookID];
+    auto& orderbookTimes              = bookStats_[bookID].orderbookUpdate_;
+    TelemetryProduct* const telemetry = bookTelemetry_[bookID];
+
+    for (const auto& level : levels) {
+      const uint64_t start = TscClock::now();
+      orderbook.buildSides(level.side_ == 'b', level.price_, level.quantity_);
+      const uint64_t elapsed = TscClock::now() - start;
+      orderbookTimes.record(elapsed);
+      if (telemetry != nullptr) {
+        telemetry->orderbookUpdate_.record(elapsed);
+      }
     }
+  }
 
-    uint16_t bookID = iter->second;
+  // Processing time runs from the frame's receipt, so with parse workers it
+  // includes the time spent queued and parsed
+  void applyL2Update(const ParsedFrame& frame, const std::size_t index)
+  {
+    // Held while the product's snapshot loads, the views are copied out
+    if (snapshotsInFlight_ != 0 && pendingBooks_[index].loading_) {
+      holdUpdate(pendingBooks_[index].held_, frame);
+      return;
+    }
+    const uint16_t bookID = subscriptionBook_[index];
+    if (bookID == noBook) {
+      return;
+    }
     auto& orderbook = orderbooksStorage_[bookID];
-    updateOrderbookL2(product_id, l2update, orderbook);
+    updateOrderbookL2(frame, bookID);
+    const uint64_t elapsed = TscClock::now() - frame.receivedTicks_;
+    bookStats_[bookID].l2update_.record(elapsed);
+    if (TelemetryProduct* telemetry = bookTelemetry_[bookID]) {
+      telemetry->l2update_.record(elapsed);
+    }
 
-    auto endL2 = std::chrono::high_resolution_clock::now();
-    l2updateTotals_[product_id].emplace_back(
-        std::chrono::duration_cast<std::chrono::nanoseconds>(endL2 - startL2)
-            .count());
+    // A truncated book that lost its retained depth needs a fresh snapshot
+    if (orderbook.isCrossed() || orderbook.needsResnapshot()) {
+      requestRestart();
+    }
+  }
 
-    if (orderbook.isCrossed()) {
-      restartWebsocket();
+  void updateOrderbookL2(const ParsedFrame& frame, const uint16_t bookID)
+  {
+    auto& orderbook                   = orderbooksStorage_[bookID];
+    auto& orderbookTimes              = bookStats_[bookID].orderbookUpdate_;
+    TelemetryProduct* const telemetry = bookTelemetry_[bookID];
+
+    bool touched{};
+    for (const auto& level : frame.levels_) {
+      const uint64_t start = TscClock::now();
+      const BookChange change =
+          orderbook.updateBook(level.side_, level.price_, level.quantity_);
+      const uint64_t elapsed = TscClock::now() - start;
+      orderbookTimes.record(elapsed);
+      if (telemetry != nullptr) {
+        telemetry->orderbookUpdate_.record(elapsed);
+      }
+
+      // Dropped by maxDepth or removing a level the book didn't hold
+      if (!change.applied_) {
+        continue;
+      }
+      touched |= change.touch_;
+      publishEvent(BookEvent{.productIndex_ = bookProductIndex_[bookID],
+                             .type_ = BookEventType::Update,
+                             .side_ = level.side_,
+                             .price_ = level.price_,
+                             .quantity_ = level.quantity_,
+                             .sequence_ = orderbook.updateCount()},
+                   frame.received_);
+    }
+    // Once per message, the batch may move the touch and put it back
+    if (touched) {
+      publishBbo(bookID, frame.received_);
     }
-    return success;
   }
 
-  void updateOrderbookL2(const std::string& product_id,
-                         const L2UpdateMsg& l2update, auto& orderbook)
+  static int64_t sinceEpoch(const auto timePoint)
   {
-    std::vector<std::size_t>& orderbookTimes = orderbookTimes_[product_id];
+    return std::chrono::duration_cast<Duration>(timePoint.time_since_epoch())
+        .count();
+  }
 
-    double price{};
-    double quantity{};
-    for (const auto& changes : l2update.changes) {
-      // Assume Successful parse
-      const char* valid =
-          fast_double_parser::parse_number(changes[1].data(), &price);
-      valid = fast_double_parser::parse_number(changes[2].data(), &quantity);
+  // Stamps and broadcasts event when the ring is on
+  void publishEvent(BookEvent event, const auto received)
+  {
+    if (!bookEvents_) {
+      return;
+    }
+    event.receiveTime_ = sinceEpoch(received);
+    event.publishTime_ = sinceEpoch(Clock::now());
+    bookEvents_->publish(event);
+  }
+
+  // Broadcasts the book's BBO when the ring is on and it differs from the
+  // last one sent
+  void publishBbo(const uint16_t bookID, const auto received)
+  {
+    if (!bboEvents_) {
+      return;
+    }
+    const Bbo bbo = orderbooksStorage_[bookID].bbo();
+    if (bbo == lastBbo_[bookID]) {
+      return;
+    }
+    lastBbo_[bookID] = bbo;
+    bboEvents_->publish(
+        BboEvent{.productIndex_ = bookProductIndex_[bookID],
+                 .bbo_ = bbo,
+                 .sequence_ = orderbooksStorage_[bookID].updateCount(),
+                 .receiveTime_ = sinceEpoch(received),
+                 .publishTime_ = sinceEpoch(Clock::now())});
+  }
 
-      auto start = std::chrono::high_resolution_clock::now();
-      orderbook.updateBook(changes[0][0], price, quantity);
-      auto end = std::chrono::high_resolution_clock::now();
+  // Frame rate since the last print and the L2 processing time over every
+  // product of this connection
+  void printThroughput()
+  {
+    const auto now     = Clock::now();
+    const auto elapsed = std::chrono::duration<double>(now - statsStart_);
+    std::cout << "\nConnection Throughput:\n";
+    std::cout << "Frames:     " << frameCount_ << '\n';
+    std::cout << "Frames/s:   "
+              << ((elapsed.count() == 0.0)
+                      ? 0.0
+                      : static_cast<double>(frameCount_) / elapsed.count())
+              << '\n';
+    frameCount_ = 0;
+    statsStart_ = now;
+
+    connectionL2_.reset();
+    for (const auto& stats : bookStats_) {
+      connectionL2_.merge(stats.l2update_);
+    }
+    if (connectionL2_.count() != 0) {
+      std::cout << "\nConnection L2 Message Processing Time:\n";
+      connectionL2_.print(tsc_.nanosPerTick());
+    }
+  }
 
-      orderbookTimes.emplace_back(
-          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-              .count());
+  // Time until every subscribed product had its first book
+  void printStartup() const
+  {
+    std::cout << "\nStartup:\n";
+    if (allBooksReady_ == Duration::zero()) {
+      std::cout << "Books Ready: " << orderbooksStorage_.size() << " of "
+                << subMessage_.product_ids.size() << '\n';
+      return;
     }
+    std::cout << "All Books Ready (ms): "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     allBooksReady_)
+                     .count()
+              << '\n';
   }
 
-  [[nodiscard]] static bool validateSubscribeRecv(const std::string& json)
+  [[nodiscard]] static bool validateSubscribeRecv(const std::string_view json)
   {
     // Could do more work here to validate, but lets assume it's successful
     SubscribeRecv subRecv;
     return glz::read_json<SubscribeRecv>(subRecv, json);
   }
 
-  static void analyzeData(std::vector<std::size_t>& data)
+  // The websocket belongs to the io_context thread. Pipelined this runs on
+  // the processing thread, so the restart is posted over there
+  void requestRestart()
   {
-    std::sort(data.begin(), data.end());
-    auto mean = std::accumulate(data.begin(), data.end(), 0.0) / data.size();
-    auto min  = data.empty() ? 0 : data.front();
-    auto max  = data.empty() ? 0 : data.back();
-    auto p99  = data.empty() ? 0 : data[0.99 * data.size()];
-
-    std::cout << "Count:     " << data.size() << "\n";
-    std::cout << "Min (ns):  " << min << '\n';
-    std::cout << "Mean (ns): " << mean << '\n';
-    std::cout << "99% (ns):  " << p99 << '\n';
-    std::cout << "Max (ns):  " << max << '\n';
+    if (!pipelined()) {
+      restartWebsocket();
+      return;
+    }
+    if (restartPending_) {
+      return;
+    }
+    restartPending_ = true;
+    boost::asio::post(ioc_, [this] { restartWebsocket(); });
   }
 
+  // On the io_context thread only, so it's the resnapshot count's one writer
   void restartWebsocket()
   {
+    if (connectionTelemetry_ != nullptr) {
+      bumpCounter(connectionTelemetry_->resnapshots_);
+    }
     websocket_->restart();
     websocket_.reset();
     subscribeToMarketData();
@@ -1,8 +1,14 @@
 #pragma once
 // Header Guard
 
+#include "clock.h"
+
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace gkp {
@@ -24,17 +30,57 @@ struct SubscribeRecv {
   std::vector<Channels> channels;
 };
 
+// Feed messages are read into reused objects, the string views point into
+// the frame and are only valid while it's being handled. Feed strings carry
+// no escapes, so they're read without a copy
 struct SnapshotMsg {
-  std::string type;
-  std::string product_id;
-  std::vector<std::array<std::string, 2>> bids;
-  std::vector<std::array<std::string, 2>> asks;
+  std::string_view type;
+  std::string_view product_id;
+  std::vector<std::array<std::string_view, 2>> bids;
+  std::vector<std::array<std::string_view, 2>> asks;
 };
 
 struct L2UpdateMsg {
-  std::string type;
-  std::string product_id;
-  std::vector<std::array<std::string, 3>> changes;
-  std::string time;
+  std::string_view type;
+  std::string_view product_id;
+  std::vector<std::array<std::string_view, 3>> changes;
+  std::string_view time;
+};
+
+// Malformed is an l2update or snapshot with a price or quantity that didn't
+// parse
+enum class FrameType : uint8_t {
+  Other,
+  L2Update,
+  Snapshot,
+  Subscriptions,
+  Malformed
+};
+
+// A change or snapshot row with its numbers converted, side is 'b' or 's'
+struct ParsedLevel {
+  char side_{};
+  double price_{};
+  double quantity_{};
+};
+
+// A frame parsed ahead of being applied, so the parsing can happen on another
+// thread. The message structs are the scratch space the views point into,
+// everything is reused from frame to frame
+struct ParsedFrame {
+  FrameType type_{};
+  // The frame itself, valid while it's being handled
+  std::string_view text_;
+  std::string_view productId_;
+  // Subscription index of productId_, resolved once by whoever hands the
+  // frame over to be applied
+  std::size_t productIndex_{};
+  // Snapshots list the bids before the asks
+  std::vector<ParsedLevel> levels_;
+  Clock::time_point received_;
+  // TscClock::now() at receipt, for the latency statistics
+  uint64_t receivedTicks_{};
+  SnapshotMsg snapshot_;
+  L2UpdateMsg l2update_;
 };
 }  // namespace gkp
@@ -1,14 +1,22 @@
 #pragma once
 // Header Guard
 
+#include "aggregated_ladder.h"
+#include "depth_cache.h"
 #include "dro/flat-rb-tree.hpp"
+#include "published_top.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <ctime>
+#include <functional>
 #include <iomanip>
+#include <iterator>
 #include <iostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace gkp {
 
@@ -19,6 +27,40 @@ struct OrderBookLevel {
   explicit OrderBookLevel(double quantity) : quantity_(quantity) {}
 };
 
+struct OrderbookOptions {
+  // Keep the top LimitOrderBook::cacheDepth levels per side in a fixed array
+  bool depthCache{};
+  // Levels retained per side, deeper changes are dropped. 0 keeps every level
+  std::size_t maxDepth{};
+  // Bucketed ladders at each multiple of tickSize, none when tickSize is 0
+  double tickSize{};
+  std::vector<std::size_t> bucketMultipliers;
+  // Publish the depth cache through a seqlock for reader threads, implies
+  // depthCache
+  bool publishTop{};
+  // POSIX shared memory name such as /coinbase_books, publishes the tops
+  // there for other processes instead. Implies publishTop
+  std::string shmName;
+  // Slots in MessageParser's book event ring, no events when 0
+  std::size_t eventCapacity{};
+  // Slots in MessageParser's BBO event ring, no events when 0
+  std::size_t bboCapacity{};
+  // POSIX shared memory name such as /coinbase_telemetry, MessageParser
+  // publishes its counters and latency histograms there when set
+  std::string telemetryName;
+};
+
+// What a single LimitOrderBook::updateBook call did to its side
+struct BookChange {
+  // The side changed, false when maxDepth dropped the change or it removed a
+  // level the book didn't hold
+  bool applied_{};
+  // Landed in the depth cache, the published top needs a rewrite
+  bool cache_{};
+  // Best price or its quantity changed, including the best level removed
+  bool touch_{};
+};
+
 class LimitOrderBook {
  public:
   using price_level  = double;
@@ -28,46 +70,370 @@ class LimitOrderBook {
   using ask_flat_map = dro::FlatMap<price_level, OrderBookLevel, uint32_t,
                                     std::less<price_level>>;
 
+  constexpr static std::size_t cacheDepth{publishedDepth};
+  using bid_depth_cache = DepthCache<cacheDepth, std::greater<price_level>>;
+  using ask_depth_cache = DepthCache<cacheDepth, std::less<price_level>>;
+
+  using bid_aggregates = std::vector<AggregatedLadder<std::greater<int64_t>>>;
+  using ask_aggregates = std::vector<AggregatedLadder<std::less<int64_t>>>;
+
+  using top_seqlock = TopSeqlock;
+
  private:
   constexpr static double epsilon = 1e-9;
   constexpr static uint16_t initialSize{500};
   bid_flat_map bid_{initialSize};
   ask_flat_map ask_{initialSize};
+  bid_depth_cache bidCache_;
+  ask_depth_cache askCache_;
+  bid_aggregates bidAggregates_;
+  ask_aggregates askAggregates_;
+  OrderbookOptions options_;
   std::string productID_;
+  // Owned by whoever hands it to the readers, outlives the book
+  top_seqlock* publisher_{};
+  uint64_t updateCount_{};
+
+  // Retained depth bookkeeping for OrderbookOptions::maxDepth
+  struct DepthLimit {
+    // Deepest retained price once truncated, levels at or better than it
+    // match the exchange and anything beyond it is unknown
+    price_level boundary_{};
+    std::size_t droppedUpdates_{};
+    bool truncated_{};
+  };
+
+  DepthLimit bidLimit_;
+  DepthLimit askLimit_;
+
+  // Changes beyond the retained levels are dropped. Once truncated the
+  // boundary stays put as erases free room, so a level that reappears past
+  // it can't be mistaken for the exchange's next level
+  template <typename Compare>
+  bool dropBeyondDepth(
+      const dro::FlatMap<price_level, OrderBookLevel, uint32_t, Compare>& side,
+      DepthLimit& limit, const price_level price) const
+  {
+    if (options_.maxDepth == 0) {
+      return false;
+    }
+    if (!limit.truncated_) {
+      if (side.size() < options_.maxDepth
+          || !Compare{}(std::prev(side.end())->first, price))
+      {
+        return false;
+      }
+      limit.truncated_ = true;
+      limit.boundary_  = std::prev(side.end())->first;
+    } else if (!Compare{}(limit.boundary_, price)) {
+      return false;
+    }
+    ++limit.droppedUpdates_;
+    return true;
+  }
+
+  // An insert past maxDepth evicts the worst level, the boundary moves up to
+  // the new deepest one. Returns true when the evicted level is the inserted
+  // price itself, it landed past the retained levels and is dropped
+  template <typename Compare, typename Cache, typename Aggregates>
+  bool trimToDepth(
+      dro::FlatMap<price_level, OrderBookLevel, uint32_t, Compare>& side,
+      Cache& cache, DepthLimit& limit, Aggregates& aggregates,
+      const price_level price)
+  {
+    if (options_.maxDepth == 0 || side.size() <= options_.maxDepth) {
+      return false;
+    }
+    const auto worst             = std::prev(side.end());
+    const price_level worstPrice = worst->first;
+    updateAggregates(aggregates, worstPrice, -worst->second.quantity_, -1);
+    side.erase(worst);
+    limit.truncated_ = true;
+    limit.boundary_  = std::prev(side.end())->first;
+    if (!Compare{}(price, worstPrice)) {
+      ++limit.droppedUpdates_;
+      return true;
+    }
+    if (options_.depthCache) {
+      updateDepthCache(side, cache, worstPrice, 0.0);
+    }
+    return false;
+  }
+
+  template <typename Compare, typename Cache, typename Aggregates>
+  BookChange updateSide(
+      dro::FlatMap<price_level, OrderBookLevel, uint32_t, Compare>& side,
+      Cache& cache, DepthLimit& limit, Aggregates& aggregates,
+      const price_level price, const double quantity)
+  {
+    if (dropBeyondDepth(side, limit, price)) {
+      return {};
+    }
+    const auto [it, inserted] = side.emplace(price);  // default value in place
+    const double previous     = it->second.quantity_;  // zero for a new level
+    it->second.quantity_      = quantity;
+    BookChange change{.applied_ = true};
+    if (quantity < epsilon) {
+      side.erase(it);
+      change.applied_ = !inserted;
+      // The removed level was the best if nothing left is better
+      change.touch_ =
+          !inserted
+          && (side.empty() || !Compare{}(side.begin()->first, price));
+      if (!inserted) {
+        updateAggregates(aggregates, price, -previous, -1);
+      }
+    } else {
+      change.touch_ = previous != quantity
+                      && !Compare{}(side.begin()->first, price);
+      updateAggregates(aggregates, price, quantity - previous,
+                       inserted ? 1 : 0);
+      if (trimToDepth(side, cache, limit, aggregates, price)) {
+        return {};
+      }
+    }
+    change.cache_ = options_.depthCache
+                    && updateDepthCache(side, cache, price, quantity);
+    return change;
+  }
+
+  template <typename Aggregates>
+  static void updateAggregates(Aggregates& aggregates, const price_level price,
+                               const double delta, const int levelDelta)
+  {
+    for (auto& ladder : aggregates) {
+      ladder.apply(price, delta, levelDelta);
+    }
+  }
+
+  // Only touches the cache when the change lands inside the top levels,
+  // returns true when it did
+  template <typename FlatMap, typename Cache>
+  static bool updateDepthCache(const FlatMap& side, Cache& cache,
+                               const price_level price, const double quantity)
+  {
+    if (quantity >= epsilon) {
+      if (!cache.covers(price)) {
+        return false;
+      }
+      cache.upsert(price, quantity);
+      return true;
+    }
+    const bool wasFull = cache.full();
+    if (!cache.erase(price)) {
+      return false;
+    }
+    if (!wasFull) {
+      return true;
+    }
+    // A full cache may have more levels behind it, pull the next one in
+    auto it = cache.empty() ? side.begin() : side.find(cache.back().price_);
+    if (!cache.empty() && it != side.end()) {
+      ++it;
+    }
+    if (it != side.end()) {
+      cache.pushBack(it->first, it->second.quantity_);
+    }
+    return true;
+  }
+
+  void printCachedLevels(const uint16_t depth) const
+  {
+    const auto askCount = std::min<std::size_t>(depth, askCache_.size());
+    for (std::size_t count = askCount; count > 0; --count) {
+      std::cout << std::fixed << std::setprecision(2) << "Level " << count
+                << " - Price: " << askCache_[count - 1].price_;
+      std::cout << std::fixed << std::setprecision(8)
+                << ", Quantity: " << askCache_[count - 1].quantity_ << '\n';
+    }
+
+    std::cout << "Bid Levels:\n";
+    const auto bidCount = std::min<std::size_t>(depth, bidCache_.size());
+    for (std::size_t count{}; count < bidCount; ++count) {
+      std::cout << std::fixed << std::setprecision(2) << "Level " << count + 1
+                << " - Price: " << bidCache_[count].price_;
+      std::cout << std::fixed << std::setprecision(8)
+                << ", Quantity: " << bidCache_[count].quantity_ << '\n';
+    }
+  }
+
+  void printAggregatedLevels(const uint16_t depth) const
+  {
+    std::vector<DepthLevel> asks;
+    for (std::size_t i{}; i < askAggregates_.size(); ++i) {
+      std::cout << "Ask Buckets (" << askAggregates_[i].multiplier()
+                << "x tick):\n";
+      asks.clear();
+      askAggregates_[i].forEach(
+          depth, [&asks](const double price, const double quantity) {
+            asks.push_back(DepthLevel{price, quantity});
+          });
+      for (std::size_t count = asks.size(); count > 0; --count) {
+        std::cout << std::fixed << std::setprecision(2) << "Level " << count
+                  << " - Price: " << asks[count - 1].price_;
+        std::cout << std::fixed << std::setprecision(8)
+                  << ", Quantity: " << asks[count - 1].quantity_ << '\n';
+      }
+
+      std::cout << "Bid Buckets (" << bidAggregates_[i].multiplier()
+                << "x tick):\n";
+      std::size_t count{};
+      bidAggregates_[i].forEach(
+          depth, [&count](const double price, const double quantity) {
+            std::cout << std::fixed << std::setprecision(2) << "Level "
+                      << ++count << " - Price: " << price;
+            std::cout << std::fixed << std::setprecision(8)
+                      << ", Quantity: " << quantity << '\n';
+          });
+    }
+  }
 
  public:
   LimitOrderBook() = default;
 
   // productID used for printing
-  explicit LimitOrderBook(std::string productID)
-      : productID_(std::move(productID))
-  {}
+  explicit LimitOrderBook(std::string productID,
+                          const OrderbookOptions& options = {})
+      : options_(options), productID_(std::move(productID))
+  {
+    if (!options_.shmName.empty()) {
+      options_.publishTop = true;
+    }
+    if (options_.publishTop) {
+      options_.depthCache = true;
+    }
+    if (options_.tickSize <= 0.0) {
+      return;
+    }
+    for (const std::size_t multiplier : options_.bucketMultipliers) {
+      bidAggregates_.emplace_back(options_.tickSize, multiplier);
+      askAggregates_.emplace_back(options_.tickSize, multiplier);
+    }
+  }
 
   void buildSides(const bool buySell, const double price, const double quantity)
   {
     if (buySell) {
-      bid_.emplace(price, OrderBookLevel{quantity});
+      if (dropBeyondDepth(bid_, bidLimit_, price)) {
+        return;
+      }
+      if (bid_.emplace(price, OrderBookLevel{quantity}).second) {
+        updateAggregates(bidAggregates_, price, quantity, 1);
+      }
+      if (!trimToDepth(bid_, bidCache_, bidLimit_, bidAggregates_, price)
+          && options_.depthCache)
+      {
+        updateDepthCache(bid_, bidCache_, price, quantity);
+      }
+      return;
+    }
+    if (dropBeyondDepth(ask_, askLimit_, price)) {
       return;
     }
-    ask_.emplace(price, OrderBookLevel{quantity});
+    if (ask_.emplace(price, OrderBookLevel{quantity}).second) {
+      updateAggregates(askAggregates_, price, quantity, 1);
+    }
+    if (!trimToDepth(ask_, askCache_, askLimit_, askAggregates_, price)
+        && options_.depthCache)
+    {
+      updateDepthCache(ask_, askCache_, price, quantity);
+    }
   }
 
-  void updateBook(const char buySell, const double price, const double quantity)
+  // What the change did, touch_ when the best bid or ask price or quantity
+  // changed
+  BookChange updateBook(const char buySell, const double price,
+                        const double quantity)
   {
-    if (buySell == 'b') {
-      const auto it =
-          bid_.emplace(price).first;  // default value built in place
-      it->second.quantity_ = quantity;
-      if (quantity < epsilon) {
-        bid_.erase(it);
-      }
+    ++updateCount_;
+    const BookChange change =
+        (buySell == 'b')
+            ? updateSide(bid_, bidCache_, bidLimit_, bidAggregates_, price,
+                         quantity)
+            : updateSide(ask_, askCache_, askLimit_, askAggregates_, price,
+                         quantity);
+    if (change.cache_) {
+      publishTop();
+    }
+    return change;
+  }
+
+  // Takes the levels of a book built elsewhere, such as from a snapshot on a
+  // loader thread, keeping this book's publisher and update count
+  void adoptLevels(LimitOrderBook&& built)
+  {
+    top_seqlock* publisher = publisher_;
+    const uint64_t updates = updateCount_;
+    *this                  = std::move(built);
+    publisher_             = publisher;
+    updateCount_           = updates;
+  }
+
+  // Readers load from publisher once set, nullptr stops publishing
+  void setPublisher(top_seqlock* publisher) { publisher_ = publisher; }
+
+  // Writes the cached top levels for reader threads, updateBook calls it
+  // whenever the top changes. Call it once the snapshot is built
+  void publishTop()
+  {
+    if (publisher_ == nullptr) {
       return;
     }
-    const auto it = ask_.emplace(price).first;  // default value built in place
-    it->second.quantity_ = quantity;
-    if (quantity < epsilon) {
-      ask_.erase(it);
+    publisher_->write([this](PublishedTop& top) {
+      top.bidCount_    = bidCache_.copyTo(top.bids_);
+      top.askCount_    = askCache_.copyTo(top.asks_);
+      top.updateCount_ = updateCount_;
+    });
+  }
+
+  // With maxDepth set, true once a truncated side holds fewer known levels
+  // than the depth cache publishes, only a fresh snapshot can fill them in
+  [[nodiscard]] bool needsResnapshot() const
+  {
+    const std::size_t wanted = std::min(options_.maxDepth, cacheDepth);
+    return (bidLimit_.truncated_ && bid_.size() < wanted)
+           || (askLimit_.truncated_ && ask_.size() < wanted);
+  }
+
+  [[nodiscard]] std::size_t droppedUpdates() const
+  {
+    return bidLimit_.droppedUpdates_ + askLimit_.droppedUpdates_;
+  }
+
+  // Best level of each side, read from the maps so no depth cache is needed
+  [[nodiscard]] Bbo bbo() const
+  {
+    Bbo bbo;
+    if (!bid_.empty()) {
+      bbo.bid_ = DepthLevel{bid_.begin()->first,
+                            bid_.begin()->second.quantity_};
     }
+    if (!ask_.empty()) {
+      bbo.ask_ = DepthLevel{ask_.begin()->first,
+                            ask_.begin()->second.quantity_};
+    }
+    return bbo;
+  }
+
+  [[nodiscard]] const std::string& productID() const { return productID_; }
+
+  // updateBook calls since construction, the version readers see
+  [[nodiscard]] uint64_t updateCount() const { return updateCount_; }
+
+  // Top cacheDepth levels, only maintained with OrderbookOptions::depthCache
+  [[nodiscard]] const bid_depth_cache& bidDepth() const { return bidCache_; }
+
+  [[nodiscard]] const ask_depth_cache& askDepth() const { return askCache_; }
+
+  // One ladder per OrderbookOptions::bucketMultipliers entry, same order
+  [[nodiscard]] const bid_aggregates& bidAggregates() const
+  {
+    return bidAggregates_;
+  }
+
+  [[nodiscard]] const ask_aggregates& askAggregates() const
+  {
+    return askAggregates_;
   }
 
   void printLevels(const uint16_t depth) const
@@ -76,6 +442,12 @@ class LimitOrderBook {
     std::cout << "\nTime: " << ctime(&now) << "Limit Orderbook: " << productID_
               << "\nAsk Levels:\n";
 
+    if (options_.depthCache && depth <= cacheDepth) {
+      printCachedLevels(depth);
+      printAggregatedLevels(depth);
+      return;
+    }
+
     int32_t count{};
     auto askEnd = ask_.end();
     auto it     = ask_.begin();
@@ -97,12 +469,23 @@ class LimitOrderBook {
       std::cout << std::fixed << std::setprecision(8)
                 << ", Quantity: " << it->second.quantity_ << '\n';
     }
+    printAggregatedLevels(depth);
   }
 
   void clearBook()
   {
     bid_.clear();
     ask_.clear();
+    bidCache_.clear();
+    askCache_.clear();
+    for (auto& ladder : bidAggregates_) {
+      ladder.clear();
+    }
+    for (auto& ladder : askAggregates_) {
+      ladder.clear();
+    }
+    bidLimit_ = DepthLimit{};
+    askLimit_ = DepthLimit{};
   }
 
   [[nodiscard]] bool isCrossed() const
@@ -0,0 +1,305 @@
+#pragma once
+// Header Guard
+
+#include "common.h"
+#include "frame_pipeline.h"
+#include "spsc_ring.h"
+#include "telemetry_layout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace gkp {
+
+// Frames are numbered in arrival order, parsed by a pool of workers in any
+// order, then applied in arrival order within each lane, one lane per
+// product. A frame still being parsed holds back only the later frames of
+// its own lane. Slots are recycled as their frames are applied, so the
+// network thread waits only when a whole ring of frames is in flight. Workers
+// with nothing to claim park until the next push rather than spin.
+template <typename Parsed>
+class ParallelParser {
+ public:
+  // Workers, any number at once, each on its own frame
+  using parse_function    = std::function<void(std::string_view, Parsed&)>;
+  // Processing thread, in order within a lane
+  using apply_function    = std::function<void(Parsed&)>;
+  using interval_callback = std::function<void()>;
+
+ private:
+  enum class SlotState : uint8_t { Free, Filled, Ready };
+
+  struct Slot {
+    std::atomic<SlotState> state_{SlotState::Free};
+    std::string text_;
+    std::size_t lane_{};
+    Parsed parsed_;
+  };
+
+  // Large enough for any l2update, snapshots grow their slot once
+  constexpr static std::size_t initialFrameSize{4096};
+  // Frames between clock reads for the interval callback
+  constexpr static std::size_t clockStride{256};
+  // Failed claims a worker yields through before it parks until a push
+  constexpr static std::size_t idleSpins{1024};
+
+  std::unique_ptr<Slot[]> slots_;
+  std::size_t mask_;
+  std::size_t workerCount_;
+  int processingCpu_;
+  std::atomic<bool> running_{};
+
+  // Written by the network thread only, frames below it are filled
+  alignas(64) std::atomic<uint64_t> head_{};
+  // Next frame for a worker to claim
+  alignas(64) std::atomic<uint64_t> nextParse_{};
+  // Workers out of frames park on wakeups_, a push bumps it only while one
+  // is parked
+  alignas(64) std::atomic<uint32_t> parkedWorkers_{};
+  std::atomic<uint32_t> wakeups_{};
+  // Producer side, pushes that found the slot still in flight and waited
+  alignas(64) std::atomic<uint64_t> fullWaits_{};
+  // Optional, never reset. Processing thread records the depth, network
+  // thread the full waits
+  TelemetryConnection* telemetry_{};
+
+  // Processing thread only. Frames below scanned_ are queued on their lane,
+  // each lane in arrival order
+  uint64_t scanned_{};
+  uint64_t applied_{};
+  std::vector<std::unique_ptr<SpscRing<uint64_t>>> lanes_;
+  // Frames in flight behind each applied one, reset by printStats
+  struct DepthStats {
+    uint64_t frames_{};
+    uint64_t depthTotal_{};
+    uint64_t depthMax_{};
+  } depth_;
+
+  std::vector<std::thread> workers_;
+  std::thread applier_;
+
+  [[nodiscard]] Slot& slot(const uint64_t sequence)
+  {
+    return slots_[static_cast<std::size_t>(sequence) & mask_];
+  }
+
+  // Sleeps until a push or stop, unless a frame arrived since sequence was
+  // read. The seq_cst pair with push() means one of them sees the other
+  void park(const uint64_t sequence)
+  {
+    const uint32_t wakeup = wakeups_.load(std::memory_order_acquire);
+    parkedWorkers_.fetch_add(1, std::memory_order_seq_cst);
+    if (sequence == head_.load(std::memory_order_seq_cst)
+        && running_.load(std::memory_order_relaxed))
+    {
+      wakeups_.wait(wakeup, std::memory_order_acquire);
+    }
+    parkedWorkers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void parse(const parse_function& parser)
+  {
+    std::size_t idle{};
+    while (running_.load(std::memory_order_relaxed)) {
+      uint64_t sequence = nextParse_.load(std::memory_order_relaxed);
+      if (sequence == head_.load(std::memory_order_acquire)) {
+        if (++idle < idleSpins) {
+          std::this_thread::yield();
+        } else {
+          park(sequence);
+          idle = 0;
+        }
+        continue;
+      }
+      if (!nextParse_.compare_exchange_weak(sequence, sequence + 1,
+                                            std::memory_order_relaxed))
+      {
+        continue;
+      }
+      idle          = 0;
+      Slot& claimed = slot(sequence);
+      parser(claimed.text_, claimed.parsed_);
+      claimed.state_.store(SlotState::Ready, std::memory_order_release);
+    }
+  }
+
+  // Applies every parsed frame at the front of its lane, a frame still being
+  // parsed holds back its lane only. Returns the count
+  std::size_t drain(const apply_function& apply)
+  {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    for (; scanned_ != head; ++scanned_) {
+      // A lane can't hold more frames than there are slots
+      SpscRing<uint64_t>& lane = *lanes_[slot(scanned_).lane_];
+      *lane.claim() = scanned_;
+      lane.push();
+    }
+    std::size_t applied{};
+    for (auto& lane : lanes_) {
+      while (const uint64_t* sequence = lane->front()) {
+        Slot& ready = slot(*sequence);
+        if (ready.state_.load(std::memory_order_acquire)
+            != SlotState::Ready)
+        {
+          break;
+        }
+        const uint64_t inFlight = head - ++applied_;
+        ++depth_.frames_;
+        depth_.depthTotal_ += inFlight;
+        depth_.depthMax_    = std::max(depth_.depthMax_, inFlight);
+        if (telemetry_ != nullptr) {
+          telemetry_->queueDepth_.record(inFlight);
+        }
+        apply(ready.parsed_);
+        ready.state_.store(SlotState::Free, std::memory_order_release);
+        lane->pop();
+        ++applied;
+      }
+    }
+    return applied;
+  }
+
+  void process(const apply_function& apply, const Duration interval,
+               const interval_callback& onInterval)
+  {
+    pinThread(processingCpu_);
+    auto next = Clock::now() + interval;
+    std::size_t sinceClock{};
+    while (running_.load(std::memory_order_relaxed)) {
+      const std::size_t applied  = drain(apply);
+      sinceClock                += applied;
+      if (applied != 0 && sinceClock < clockStride) {
+        continue;
+      }
+      sinceClock = 0;
+      if (onInterval && Clock::now() >= next) {
+        onInterval();
+        next += interval;
+      }
+      // Only gives the core up when another thread is waiting for it
+      std::this_thread::yield();
+    }
+  }
+
+ public:
+  // Uses options.ringSlots, rounded up to a power of two, and pins the
+  // processing thread to options.processingCpu. Workers aren't pinned
+  ParallelParser(const PipelineOptions& options, const std::size_t workers,
+                 const std::size_t laneCount)
+      : mask_(std::bit_ceil(options.ringSlots < 2 ? 2 : options.ringSlots)
+              - 1),
+        workerCount_(workers == 0 ? 1 : workers),
+        processingCpu_(options.processingCpu)
+  {
+    slots_ = std::make_unique<Slot[]>(mask_ + 1);
+    for (std::size_t i{}; i <= mask_; ++i) {
+      slots_[i].text_.reserve(initialFrameSize);
+    }
+    for (std::size_t i{}; i < laneCount; ++i) {
+      lanes_.push_back(std::make_unique<SpscRing<uint64_t>>(mask_ + 1));
+    }
+  }
+
+  ~ParallelParser() { stop(); }
+
+  // Non-copyable & Non-moveable
+  ParallelParser(const ParallelParser&)            = delete;
+  ParallelParser& operator=(const ParallelParser&) = delete;
+  ParallelParser(ParallelParser&&)                 = delete;
+  ParallelParser& operator=(ParallelParser&&)      = delete;
+
+  // Before start
+  void setTelemetry(TelemetryConnection* telemetry) { telemetry_ = telemetry; }
+
+  // parser runs on the workers, apply and onInterval on the processing
+  // thread
+  void start(parse_function parser, apply_function apply,
+             const Duration interval, interval_callback onInterval)
+  {
+    running_.store(true, std::memory_order_relaxed);
+    for (std::size_t i{}; i < workerCount_; ++i) {
+      workers_.emplace_back([this, parser] { parse(parser); });
+    }
+    applier_ = std::thread{[this, apply = std::move(apply), interval,
+                            onInterval = std::move(onInterval)] {
+      process(apply, interval, onInterval);
+    }};
+  }
+
+  void stop()
+  {
+    running_.store(false, std::memory_order_relaxed);
+    wakeups_.fetch_add(1, std::memory_order_release);
+    wakeups_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+    if (applier_.joinable()) {
+      applier_.join();
+    }
+  }
+
+  // Network thread. tag(frame, parsed) runs before the frame is queued, it
+  // returns the frame's lane, below the constructor's laneCount, and may
+  // stamp parsed, e.g. with the receive time. Waits while the frame a ring
+  // ago is still in flight, dropping a frame would corrupt the book
+  template <typename Tag>
+  void push(const std::string_view frame, Tag&& tag)
+  {
+    const uint64_t sequence = head_.load(std::memory_order_relaxed);
+    Slot& filled            = slot(sequence);
+    if (filled.state_.load(std::memory_order_acquire) != SlotState::Free) {
+      fullWaits_.fetch_add(1, std::memory_order_relaxed);
+      if (telemetry_ != nullptr) {
+        bumpCounter(telemetry_->fullWaits_);
+      }
+      while (filled.state_.load(std::memory_order_acquire)
+             != SlotState::Free)
+      {
+        std::this_thread::yield();
+      }
+    }
+    // std::string keeps the null after the frame that the parser needs
+    filled.text_.assign(frame);
+    filled.lane_ = tag(filled.text_, filled.parsed_);
+    filled.state_.store(SlotState::Filled, std::memory_order_relaxed);
+    head_.store(sequence + 1, std::memory_order_seq_cst);
+    // Workers only park once they run out of frames, under load this is a
+    // load and nothing more
+    if (parkedWorkers_.load(std::memory_order_seq_cst) != 0) {
+      wakeups_.fetch_add(1, std::memory_order_release);
+      wakeups_.notify_all();
+    }
+  }
+
+  // Processing thread, from the interval callback
+  void printStats()
+  {
+    std::cout << "\nParallel Parsing, Frames In Flight:\n";
+    std::cout << "Workers:    " << workerCount_ << '\n';
+    std::cout << "Frames:     " << depth_.frames_ << '\n';
+    std::cout << "Mean:       "
+              << ((depth_.frames_ == 0)
+                      ? 0.0
+                      : static_cast<double>(depth_.depthTotal_)
+                            / static_cast<double>(depth_.frames_))
+              << '\n';
+    std::cout << "Max:        " << depth_.depthMax_ << '\n';
+    std::cout << "Capacity:   " << (mask_ + 1) << '\n';
+    std::cout << "Full Waits: "
+              << fullWaits_.exchange(0, std::memory_order_relaxed) << '\n';
+    depth_ = DepthStats{};
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,36 @@
+#pragma once
+// Header Guard
+
+#include "depth_cache.h"
+#include "seqlock.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gkp {
+
+// Levels per side in a published block
+constexpr std::size_t publishedDepth{10};
+
+// Top of book block published for readers in other threads or processes.
+// Trivially copyable with a fixed layout, so it can live in shared memory.
+struct PublishedTop {
+  std::array<DepthLevel, publishedDepth> bids_{};
+  std::array<DepthLevel, publishedDepth> asks_{};
+  std::size_t bidCount_{};
+  std::size_t askCount_{};
+  // Book updates applied when the block was written
+  uint64_t updateCount_{};
+};
+
+using TopSeqlock = Seqlock<PublishedTop>;
+
+// Best level of each side, a zero quantity marks an empty side
+struct Bbo {
+  DepthLevel bid_{};
+  DepthLevel ask_{};
+
+  bool operator==(const Bbo&) const = default;
+};
+}  // namespace gkp
@@ -0,0 +1,104 @@
+#pragma once
+// Header Guard
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace gkp {
+
+// Single writer, many readers. The writer bumps the sequence to odd, writes
+// the block and bumps it back to even, it never waits on a reader. A reader
+// copies the block and retries if the sequence was odd or moved during the
+// copy, so it only ever sees whole versions.
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Seqlock blocks are copied with memcpy");
+
+ private:
+  // Fixed rather than hardware_destructive_interference_size, which can
+  // change with compiler flags and the block layout is shared across threads
+  constexpr static std::size_t cacheLine = 64;
+
+  alignas(cacheLine) std::atomic<uint64_t> sequence_{};
+  // Own cache line, readers polling the sequence don't share it with the data
+  alignas(cacheLine) T data_{};
+
+ public:
+  Seqlock()  = default;
+  ~Seqlock() = default;
+  // Non-copyable & Non-moveable
+  Seqlock(const Seqlock&)            = delete;
+  Seqlock& operator=(const Seqlock&) = delete;
+  Seqlock(Seqlock&&)                 = delete;
+  Seqlock& operator=(Seqlock&&)      = delete;
+
+  // Writer thread only, function fills the block in place
+  template <typename Function>
+  void write(Function&& function)
+  {
+    const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    function(data_);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  void store(const T& value)
+  {
+    write([&value](T& data) { std::memcpy(&data, &value, sizeof(T)); });
+  }
+
+  // Returns false when a write overlapped the copy, version is the one copied
+  [[nodiscard]] bool tryLoad(T& value, uint64_t& version) const
+  {
+    const uint64_t before = sequence_.load(std::memory_order_acquire);
+    if (before & 1) {
+      return false;
+    }
+    std::memcpy(&value, &data_, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    version = before / 2;
+    return sequence_.load(std::memory_order_relaxed) == before;
+  }
+
+  // Spins until a consistent copy and returns its version. The writer never
+  // blocks, so the spin is bounded by the write rate
+  uint64_t load(T& value) const
+  {
+    uint64_t version{};
+    while (!tryLoad(value, version)) {
+    }
+    return version;
+  }
+
+  // Calls function on the block in place until it ran against one whole
+  // version and returns its result, no copy of the block. function may see a
+  // torn block on the runs that get retried, so it must only copy values out
+  // and clamp anything it uses as an index
+  template <typename Function>
+  auto read(Function&& function) const
+  {
+    for (;;) {
+      const uint64_t before = sequence_.load(std::memory_order_acquire);
+      if (before & 1) {
+        continue;
+      }
+      const auto result = function(static_cast<const T&>(data_));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == before) {
+        return result;
+      }
+    }
+  }
+
+  // Completed writes, readers compare it to spot a new version cheaply
+  [[nodiscard]] uint64_t version() const
+  {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+};
+}  // namespace gkp
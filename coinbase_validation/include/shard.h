@@ -0,0 +1,180 @@
+#pragma once
+// Header Guard
+
+#include "common.h"
+#include "frame_pipeline.h"
+#include "loop.h"
+#include "message_parser.h"
+#include "message_types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gkp {
+
+// Products dealt round robin over at most count subscriptions, list the hot
+// products first to give each a connection of its own
+[[nodiscard]] inline std::vector<SubscribeMsg>
+splitProducts(const SubscribeMsg& sub, const std::size_t count)
+{
+  const std::size_t products = std::max<std::size_t>(sub.product_ids.size(), 1);
+  const std::size_t shards   = std::clamp<std::size_t>(count, 1, products);
+  std::vector<SubscribeMsg> result(shards, SubscribeMsg{});
+  for (std::size_t i{}; i < sub.product_ids.size(); ++i) {
+    result[i % shards].product_ids.push_back(sub.product_ids[i]);
+  }
+  return result;
+}
+
+// Pinned cores of the index-th shard. Each shard takes its own block of as
+// many cores as it pins threads, so with --network-cpu 2 --processing-cpu 3
+// shard 1 pins to 4 and 5
+[[nodiscard]] inline PipelineOptions
+shardPipelineOptions(PipelineOptions options, const std::size_t index)
+{
+  const int pinned = static_cast<int>(options.networkCpu >= 0)
+                     + static_cast<int>(options.processingCpu >= 0);
+  const int offset = static_cast<int>(index) * pinned;
+  if (options.networkCpu >= 0) {
+    options.networkCpu += offset;
+  }
+  if (options.processingCpu >= 0) {
+    options.processingCpu += offset;
+  }
+  return options;
+}
+
+// False, after printing the core, when two pinned threads of any of the
+// shards would share a core
+[[nodiscard]] inline bool
+checkShardCores(const PipelineOptions& options, const std::size_t shards)
+{
+  std::vector<int> cores;
+  for (std::size_t i{}; i < shards; ++i) {
+    const PipelineOptions shard = shardPipelineOptions(options, i);
+    if (shard.networkCpu >= 0) {
+      cores.push_back(shard.networkCpu);
+    }
+    if (shard.processingCpu >= 0) {
+      cores.push_back(shard.processingCpu);
+    }
+  }
+  std::ranges::sort(cores);
+  const auto shared = std::ranges::adjacent_find(cores);
+  if (shared != cores.end()) {
+    std::cerr << "Core " << *shared
+              << " would be pinned twice, give --network-cpu and "
+                 "--processing-cpu cores that stay apart across the shards\n";
+    return false;
+  }
+  return true;
+}
+
+// One websocket connection with its own io_context, thread and books. Shards
+// share nothing on the hot path, only printing takes printMutex so their
+// reports don't interleave. With several shards the shared memory segments
+// get per shard names, shmName.<index> and telemetryName.<index>, and each
+// shard pins to its own block of cores, see shardPipelineOptions.
+class Shard {
+ private:
+  std::size_t index_;
+  std::size_t count_;
+  SubscribeMsg sub_;
+  PipelineOptions pipelineOptions_;
+  io_context ioc_;
+  MessageParser parser_;
+  std::optional<Loop> loop_;
+  std::mutex& printMutex_;
+  std::thread thread_;
+
+  static OrderbookOptions shardBookOptions(OrderbookOptions options,
+                                           const std::size_t index,
+                                           const std::size_t count)
+  {
+    if (count > 1 && !options.shmName.empty()) {
+      options.shmName += "." + std::to_string(index);
+    }
+    if (count > 1 && !options.telemetryName.empty()) {
+      options.telemetryName += "." + std::to_string(index);
+    }
+    return options;
+  }
+
+  void print(const uint16_t depth)
+  {
+    const std::lock_guard lock{printMutex_};
+    if (count_ > 1) {
+      std::cout << "\n===== Shard " << index_ << " of " << count_ << " =====\n";
+    }
+    parser_.printOrderbookWithStats(depth);
+    std::cout.flush();
+  }
+
+ public:
+  Shard(const std::size_t index, const std::size_t count,
+        const SubscribeMsg& sub, ssl_context& ctx,
+        const OrderbookOptions& bookOptions,
+        const PipelineOptions& pipelineOptions, std::mutex& printMutex)
+      : index_(index),
+        count_(count),
+        sub_(sub),
+        pipelineOptions_(shardPipelineOptions(pipelineOptions, index)),
+        parser_(sub_, ioc_, ctx, shardBookOptions(bookOptions, index, count),
+                pipelineOptions_),
+        printMutex_(printMutex)
+  {
+  }
+
+  ~Shard()
+  {
+    ioc_.stop();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  // Non-copyable & Non-moveable
+  Shard(const Shard&)            = delete;
+  Shard& operator=(const Shard&) = delete;
+  Shard(Shard&&)                 = delete;
+  Shard& operator=(Shard&&)      = delete;
+
+  [[nodiscard]] MessageParser& parser() { return parser_; }
+
+  // Connects and runs the io_context on the calling thread, doesn't return
+  // while the connection is up. The books belong to the processing thread
+  // when pipelined, it prints them. Without printing the statistics are
+  // only in the telemetry segment
+  void run(const Duration interval, const uint16_t depth, const bool printing)
+  {
+    FramePipeline::interval_callback printBooks;
+    if (printing) {
+      printBooks = [this, depth] { print(depth); };
+    }
+    if (parser_.pipelined()) {
+      parser_.startProcessing(interval, printBooks);
+    } else if (printing) {
+      loop_.emplace(ioc_, interval, printBooks);
+    }
+    pinThread(pipelineOptions_.networkCpu);
+    parser_.subscribeToMarketData();
+    ioc_.run();
+  }
+
+  // run() on a thread of the shard's own
+  void start(const Duration interval, const uint16_t depth,
+             const bool printing)
+  {
+    thread_ = std::thread{[this, interval, depth, printing] {
+      run(interval, depth, printing);
+    }};
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,153 @@
+#pragma once
+// Header Guard
+
+// Reader library for the shared memory books. Header only and independent of
+// the feed handler, include it with shm_layout.h, published_top.h,
+// depth_cache.h and seqlock.h. open() and close() make syscalls, reads are
+// plain loads from the mapping.
+
+#include "shm_layout.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace gkp {
+
+class ShmBookReader {
+ private:
+  const void* base_{MAP_FAILED};
+  std::size_t size_{};
+
+  [[nodiscard]] const ShmHeader& header() const
+  {
+    return *static_cast<const ShmHeader*>(base_);
+  }
+
+ public:
+  ShmBookReader() = default;
+
+  ~ShmBookReader() { close(); }
+
+  // Non-copyable & Non-moveable
+  ShmBookReader(const ShmBookReader&)            = delete;
+  ShmBookReader& operator=(const ShmBookReader&) = delete;
+  ShmBookReader(ShmBookReader&&)                 = delete;
+  ShmBookReader& operator=(ShmBookReader&&)      = delete;
+
+  // Maps the segment read only. False when it doesn't exist, isn't ready yet
+  // or was written by a different layout version
+  bool open(const char* name)
+  {
+    close();
+    const int fd = ::shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+      return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) == -1
+        || static_cast<std::size_t>(info.st_size) < sizeof(ShmHeader))
+    {
+      ::close(fd);
+      return false;
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    base_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+      return false;
+    }
+    const ShmHeader& head = header();
+    if (head.ready_.load(std::memory_order_acquire) == 0
+        || head.magic_ != shmMagic || head.layoutVersion_ != shmLayoutVersion
+        || size_ < shmSegmentSize(head.productCount_))
+    {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close()
+  {
+    if (base_ != MAP_FAILED) {
+      ::munmap(const_cast<void*>(base_), size_);
+      base_ = MAP_FAILED;
+    }
+  }
+
+  [[nodiscard]] std::size_t productCount() const
+  {
+    return header().productCount_;
+  }
+
+  [[nodiscard]] const ShmBookSlot& slot(const std::size_t index) const
+  {
+    return *reinterpret_cast<const ShmBookSlot*>(
+        static_cast<const std::byte*>(base_) + sizeof(ShmHeader)
+        + index * sizeof(ShmBookSlot));
+  }
+
+  // nullptr when the product isn't published. Look it up once, keep the slot
+  [[nodiscard]] const ShmBookSlot* find(const std::string_view product) const
+  {
+    for (std::size_t i{}; i < productCount(); ++i) {
+      const ShmBookSlot& book = slot(i);
+      if (std::string_view{book.productID_.data()} == product) {
+        return &book;
+      }
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] static Bbo readBbo(const ShmBookSlot& book)
+  {
+    return book.top_.read([](const PublishedTop& top) {
+      Bbo bbo;
+      if (top.bidCount_ != 0) {
+        bbo.bid_ = top.bids_[0];
+      }
+      if (top.askCount_ != 0) {
+        bbo.ask_ = top.asks_[0];
+      }
+      return bbo;
+    });
+  }
+
+  struct DepthCount {
+    std::size_t bids_{};
+    std::size_t asks_{};
+  };
+
+  // Copies up to the span sizes of levels per side, best first, and returns
+  // the number of bid and ask levels written
+  [[nodiscard]] static DepthCount readDepth(const ShmBookSlot& book,
+                                            const std::span<DepthLevel> bids,
+                                            const std::span<DepthLevel> asks)
+  {
+    return book.top_.read([&bids, &asks](const PublishedTop& top) {
+      // A torn count is only seen on a run that gets retried, clamp anyway
+      const std::size_t bidCount =
+          std::min({top.bidCount_, publishedDepth, bids.size()});
+      const std::size_t askCount =
+          std::min({top.askCount_, publishedDepth, asks.size()});
+      std::copy_n(top.bids_.begin(), bidCount, bids.begin());
+      std::copy_n(top.asks_.begin(), askCount, asks.begin());
+      return DepthCount{bidCount, askCount};
+    });
+  }
+
+  // Completed publishes of the book, poll it to wait for a change
+  [[nodiscard]] static uint64_t version(const ShmBookSlot& book)
+  {
+    return book.top_.version();
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,44 @@
+#pragma once
+// Header Guard
+
+#include "published_top.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gkp {
+
+// Shared memory book segment, a header followed by one slot per product in
+// subscription order. Shared by the publisher and the reader library, any
+// change to these structs must bump shmLayoutVersion.
+constexpr uint64_t shmMagic{0x6b6f6f4273626b67};  // "gkbsBook"
+constexpr uint32_t shmLayoutVersion{2};
+constexpr std::size_t shmProductIDSize{32};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Seqlock sequences in shared memory must be lock free");
+
+struct alignas(64) ShmHeader {
+  uint64_t magic_{};
+  uint32_t layoutVersion_{};
+  uint32_t productCount_{};
+  // Publisher's pid, another publisher only replaces the segment once it is
+  // gone
+  int32_t ownerPid_{};
+  // Set last by the publisher, the slots are initialized once readers see it
+  std::atomic<uint32_t> ready_{};
+};
+
+struct alignas(64) ShmBookSlot {
+  // Null terminated, truncated past shmProductIDSize - 1
+  std::array<char, shmProductIDSize> productID_{};
+  TopSeqlock top_;
+};
+
+[[nodiscard]] constexpr std::size_t shmSegmentSize(const std::size_t products)
+{
+  return sizeof(ShmHeader) + products * sizeof(ShmBookSlot);
+}
+}  // namespace gkp
@@ -0,0 +1,112 @@
+#pragma once
+// Header Guard
+
+#include "shm_layout.h"
+#include "shm_segment.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace gkp {
+
+// Owns the shared memory book segment. Creates it at open, replacing only one
+// left behind by a publisher that has exited, and unlinks it on close.
+// Readers that still have it mapped keep working, only new opens fail.
+class ShmPublisher {
+ private:
+  std::string name_;
+  void* base_{MAP_FAILED};
+  std::size_t size_{};
+
+  void fail(const char* what) const
+  {
+    std::cerr << what << " " << name_ << ": " << std::strerror(errno) << "\n";
+  }
+
+ public:
+  ShmPublisher() = default;
+
+  ~ShmPublisher() { close(); }
+
+  // Non-copyable & Non-moveable
+  ShmPublisher(const ShmPublisher&)            = delete;
+  ShmPublisher& operator=(const ShmPublisher&) = delete;
+  ShmPublisher(ShmPublisher&&)                 = delete;
+  ShmPublisher& operator=(ShmPublisher&&)      = delete;
+
+  // Returns false and prints the error when the segment can't be created
+  bool open(const std::string& name, const std::vector<std::string>& products)
+  {
+    close();
+    name_ = name;
+    size_ = shmSegmentSize(products.size());
+    const int fd =
+        createShmSegment<ShmHeader>(name_, shmMagic, shmLayoutVersion);
+    if (fd == -1) {
+      return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size_)) == -1) {
+      fail("ftruncate");
+      ::close(fd);
+      ::shm_unlink(name_.c_str());
+      return false;
+    }
+    base_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+      fail("mmap");
+      ::shm_unlink(name_.c_str());
+      return false;
+    }
+
+    auto* header           = new (base_) ShmHeader{};
+    header->magic_         = shmMagic;
+    header->layoutVersion_ = shmLayoutVersion;
+    header->productCount_  = static_cast<uint32_t>(products.size());
+    header->ownerPid_      = ::getpid();
+    for (std::size_t i{}; i < products.size(); ++i) {
+      auto* slot = new (slotAddress(i)) ShmBookSlot{};
+      const std::size_t length =
+          std::min(products[i].size(), shmProductIDSize - 1);
+      std::memcpy(slot->productID_.data(), products[i].data(), length);
+    }
+    header->ready_.store(1, std::memory_order_release);
+    return true;
+  }
+
+  // Seqlock of the index-th product, valid until close
+  [[nodiscard]] TopSeqlock* top(const std::size_t index)
+  {
+    return &static_cast<ShmBookSlot*>(slotAddress(index))->top_;
+  }
+
+  [[nodiscard]] bool isOpen() const { return base_ != MAP_FAILED; }
+
+  void close()
+  {
+    if (base_ == MAP_FAILED) {
+      return;
+    }
+    ::munmap(base_, size_);
+    ::shm_unlink(name_.c_str());
+    base_ = MAP_FAILED;
+  }
+
+ private:
+  [[nodiscard]] void* slotAddress(const std::size_t index) const
+  {
+    return static_cast<std::byte*>(base_) + sizeof(ShmHeader)
+           + index * sizeof(ShmBookSlot);
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,86 @@
+#pragma once
+// Header Guard
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace gkp {
+
+// Publisher of an existing segment, read from its header's ownerPid_. 0 when
+// the segment is gone, not ready yet or written by another layout version
+template <typename Header>
+[[nodiscard]] pid_t shmOwner(const std::string& name, const uint64_t magic,
+                             const uint32_t layoutVersion)
+{
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    return 0;
+  }
+  pid_t owner{};
+  struct stat info {};
+  if (::fstat(fd, &info) == 0
+      && static_cast<std::size_t>(info.st_size) >= sizeof(Header))
+  {
+    void* base = ::mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+    if (base != MAP_FAILED) {
+      const auto& header = *static_cast<const Header*>(base);
+      if (header.ready_.load(std::memory_order_acquire) != 0
+          && header.magic_ == magic && header.layoutVersion_ == layoutVersion)
+      {
+        owner = header.ownerPid_;
+      }
+      ::munmap(base, sizeof(Header));
+    }
+  }
+  ::close(fd);
+  return owner;
+}
+
+// Creates the segment exclusively and returns its read write descriptor.
+// An existing one is only replaced when the pid in its header no longer
+// exists, a segment still in use or with an unknown owner is left alone.
+// Returns -1 and prints the error otherwise
+template <typename Header>
+[[nodiscard]] int createShmSegment(const std::string& name,
+                                   const uint64_t magic,
+                                   const uint32_t layoutVersion)
+{
+  int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd != -1) {
+    return fd;
+  }
+  if (errno != EEXIST) {
+    std::cerr << "shm_open " << name << ": " << std::strerror(errno) << "\n";
+    return -1;
+  }
+  const pid_t owner = shmOwner<Header>(name, magic, layoutVersion);
+  if (owner == 0) {
+    std::cerr << "shm_open " << name << ": exists with an unknown owner, "
+              << "remove /dev/shm" << name << " if no publisher is using it\n";
+    return -1;
+  }
+  if (::kill(owner, 0) == 0 || errno != ESRCH) {
+    std::cerr << "shm_open " << name << ": in use by pid " << owner << "\n";
+    return -1;
+  }
+  // Left behind by a publisher that exited without unlinking it
+  ::shm_unlink(name.c_str());
+  fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd == -1) {
+    std::cerr << "shm_open " << name << ": " << std::strerror(errno) << "\n";
+  }
+  return fd;
+}
+}  // namespace gkp
@@ -0,0 +1,151 @@
+#pragma once
+// Header Guard
+
+#include "clock.h"
+#include "message_types.h"
+#include "orderbook.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace gkp {
+
+// Builds books from snapshot frames on a pool of threads, so the burst of
+// snapshots at startup is parsed and loaded in parallel. Each book is built
+// on its own, without a publisher, and handed back through takeLoaded for
+// the thread that owns the books to swap in. Workers sleep while there's
+// nothing to load, snapshots only come at startup and after a restart.
+class SnapshotLoader {
+ public:
+  using time_point     = Clock::time_point;
+  // Workers, any number at once, each with its own frame
+  using parse_function = std::function<void(std::string_view, ParsedFrame&)>;
+
+  struct Loaded {
+    std::string productID_;
+    // The submit call's, only the latest per product is current
+    uint64_t generation_{};
+    time_point received_;
+    uint64_t receivedTicks_{};
+    // False when the frame didn't parse as a snapshot of the product, book_
+    // is then empty and only a fresh snapshot can build it
+    bool parsed_{};
+    LimitOrderBook book_;
+  };
+
+ private:
+  struct Job {
+    std::string text_;
+    std::string productID_;
+    uint64_t generation_{};
+    time_point received_;
+    uint64_t receivedTicks_{};
+  };
+
+  OrderbookOptions bookOptions_;
+  parse_function parser_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Job> jobs_;
+  std::vector<Loaded> loaded_;
+  bool stopping_{};
+  std::vector<std::thread> workers_;
+
+  void work()
+  {
+    ParsedFrame frame;
+    while (true) {
+      Job job;
+      {
+        std::unique_lock lock{mutex_};
+        wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+          return;
+        }
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+      parser_(job.text_, frame);
+      // A frame that fails to parse leaves the product empty
+      const bool parsed = frame.type_ == FrameType::Snapshot
+                          && frame.productId_ == job.productID_;
+      Loaded result{.productID_ = job.productID_,
+                    .generation_ = job.generation_,
+                    .received_ = job.received_,
+                    .receivedTicks_ = job.receivedTicks_,
+                    .parsed_ = parsed,
+                    .book_ = LimitOrderBook{job.productID_, bookOptions_}};
+      for (const auto& level : frame.levels_) {
+        result.book_.buildSides(level.side_ == 'b', level.price_,
+                                level.quantity_);
+      }
+      const std::lock_guard lock{mutex_};
+      loaded_.push_back(std::move(result));
+    }
+  }
+
+ public:
+  // parser fills the frame's product and levels, bids before asks
+  SnapshotLoader(const OrderbookOptions& bookOptions, parse_function parser,
+                 const std::size_t workers)
+      : bookOptions_(bookOptions), parser_(std::move(parser))
+  {
+    for (std::size_t i{}; i < (workers == 0 ? 1 : workers); ++i) {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  ~SnapshotLoader()
+  {
+    {
+      const std::lock_guard lock{mutex_};
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  // Non-copyable & Non-moveable
+  SnapshotLoader(const SnapshotLoader&)            = delete;
+  SnapshotLoader& operator=(const SnapshotLoader&) = delete;
+  SnapshotLoader(SnapshotLoader&&)                 = delete;
+  SnapshotLoader& operator=(SnapshotLoader&&)      = delete;
+
+  // Copies the frame and product, they can go as soon as this returns
+  void submit(const std::string_view frame, const std::string_view productID,
+              const uint64_t generation, const time_point received,
+              const uint64_t receivedTicks)
+  {
+    {
+      const std::lock_guard lock{mutex_};
+      jobs_.push_back(Job{.text_ = std::string{frame},
+                          .productID_ = std::string{productID},
+                          .generation_ = generation,
+                          .received_ = received,
+                          .receivedTicks_ = receivedTicks});
+    }
+    wake_.notify_one();
+  }
+
+  // Moves the books built since the last call into loaded, which is cleared
+  // first
+  void takeLoaded(std::vector<Loaded>& loaded)
+  {
+    loaded.clear();
+    const std::lock_guard lock{mutex_};
+    loaded.swap(loaded_);
+  }
+};
+}  // namespace gkp
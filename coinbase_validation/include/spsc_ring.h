@@ -0,0 +1,95 @@
+#pragma once
+// Header Guard
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gkp {
+
+// Single producer, single consumer queue over slots allocated up front.
+// Slots are filled and drained in place, so a slot type that keeps its
+// capacity, such as std::string, makes the steady state allocation free. Each
+// side caches the other's index and only reloads it when the cache says the
+// ring is full or empty.
+template <typename T>
+class SpscRing {
+ private:
+  constexpr static std::size_t cacheLine = 64;
+
+  std::vector<T> slots_;
+  std::size_t mask_;
+
+  // Producer line
+  alignas(cacheLine) std::atomic<uint64_t> head_{};
+  uint64_t cachedTail_{};
+  // Consumer line
+  alignas(cacheLine) std::atomic<uint64_t> tail_{};
+  uint64_t cachedHead_{};
+
+ public:
+  // capacity is rounded up to a power of two, every slot a copy of prototype
+  explicit SpscRing(const std::size_t capacity, const T& prototype = T{})
+      : slots_(std::bit_ceil(capacity < 2 ? 2 : capacity), prototype),
+        mask_(slots_.size() - 1)
+  {
+  }
+
+  ~SpscRing() = default;
+  // Non-copyable & Non-moveable
+  SpscRing(const SpscRing&)            = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+  SpscRing(SpscRing&&)                 = delete;
+  SpscRing& operator=(SpscRing&&)      = delete;
+
+  // Producer: slot to fill, nullptr when full. push() hands it over
+  [[nodiscard]] T* claim()
+  {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - cachedTail_ == slots_.size()) {
+      cachedTail_ = tail_.load(std::memory_order_acquire);
+      if (head - cachedTail_ == slots_.size()) {
+        return nullptr;
+      }
+    }
+    return &slots_[head & mask_];
+  }
+
+  void push()
+  {
+    head_.store(head_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  // Consumer: oldest filled slot, nullptr when empty. pop() releases it
+  [[nodiscard]] T* front()
+  {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cachedHead_) {
+      cachedHead_ = head_.load(std::memory_order_acquire);
+      if (tail == cachedHead_) {
+        return nullptr;
+      }
+    }
+    return &slots_[tail & mask_];
+  }
+
+  void pop()
+  {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  // Filled slots, exact from either side's own thread and a snapshot
+  // otherwise
+  [[nodiscard]] std::size_t size() const
+  {
+    return head_.load(std::memory_order_acquire)
+           - tail_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] std::size_t capacity() const { return slots_.size(); }
+};
+}  // namespace gkp
@@ -0,0 +1,98 @@
+#pragma once
+// Header Guard
+
+#include "latency_histogram.h"
+#include "shm_layout.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gkp {
+
+// Shared memory telemetry segment, a header, the connection's counters and
+// one slot per product in subscription order. Counters and histograms only
+// ever grow, a reader takes two samples and subtracts them for the rates and
+// percentiles in between. Every field has a single writer, so recording is
+// plain loads and stores, never a locked instruction. Shared by the
+// publisher and the reader, any change to these structs must bump
+// telemetryLayoutVersion.
+constexpr uint64_t telemetryMagic{0x7972746d656c6574};  // "telemtry"
+constexpr uint32_t telemetryLayoutVersion{2};
+
+// Single writer increment, readers see the old or the new count
+inline void bumpCounter(std::atomic<uint64_t>& counter, const uint64_t by = 1)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + by,
+                std::memory_order_relaxed);
+}
+
+// LatencyHistogram's buckets over atomics, without min, which can't be
+// subtracted. Latencies are in TSC ticks, see TelemetryHeader::nanosPerTick_
+struct alignas(64) TelemetryHistogram {
+  std::array<std::atomic<uint64_t>, LatencyHistogram::bucketCount> counts_{};
+  // Released after the bucket, a reader that acquires it first sees buckets
+  // covering it
+  std::atomic<uint64_t> count_{};
+  std::atomic<uint64_t> sum_{};
+  std::atomic<uint64_t> max_{};
+
+  void record(const uint64_t value)
+  {
+    bumpCounter(counts_[LatencyHistogram::bucketOf(value)]);
+    count_.store(count_.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+    bumpCounter(sum_, value);
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+};
+
+struct alignas(64) TelemetryHeader {
+  uint64_t magic_{};
+  uint32_t layoutVersion_{};
+  uint32_t productCount_{};
+  // The publisher's TSC rate, for the histograms
+  double nanosPerTick_{};
+  // Publisher's pid, another publisher only replaces the segment once it is
+  // gone
+  int32_t ownerPid_{};
+  // Set last by the publisher, the slots are initialized once readers see it
+  std::atomic<uint32_t> ready_{};
+};
+
+struct alignas(64) TelemetryConnection {
+  // Processing thread, or the frame thread when not pipelined
+  std::atomic<uint64_t> frames_{};
+  // From construction until every subscribed product had a book, 0 until
+  // then
+  std::atomic<uint64_t> allBooksReadyNanos_{};
+  // Frames queued behind each applied one, pipelined only
+  TelemetryHistogram queueDepth_;
+  // Network thread, pushes that found the pipeline full and waited
+  alignas(64) std::atomic<uint64_t> fullWaits_{};
+  // io_context thread, websocket restarts for a crossed or drained book
+  alignas(64) std::atomic<uint64_t> resnapshots_{};
+};
+
+struct alignas(64) TelemetryProduct {
+  // Null terminated, truncated past shmProductIDSize - 1
+  std::array<char, shmProductIDSize> productID_{};
+  std::atomic<uint64_t> snapshots_{};
+  // Receipt to book ready of the last snapshot
+  std::atomic<uint64_t> snapshotTicks_{};
+  // Receipt to applied, per l2update
+  TelemetryHistogram l2update_;
+  // Per level of l2updates and snapshots
+  TelemetryHistogram orderbookUpdate_;
+};
+
+[[nodiscard]] constexpr std::size_t telemetrySegmentSize(
+    const std::size_t products)
+{
+  return sizeof(TelemetryHeader) + sizeof(TelemetryConnection)
+         + products * sizeof(TelemetryProduct);
+}
+}  // namespace gkp
@@ -0,0 +1,117 @@
+#pragma once
+// Header Guard
+
+#include "shm_segment.h"
+#include "telemetry_layout.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace gkp {
+
+// Owns the shared memory telemetry segment, the same way ShmPublisher owns
+// the book segment. Creates it at open, replacing only one whose publisher
+// has exited, and unlinks it on close.
+class TelemetryPublisher {
+ private:
+  std::string name_;
+  void* base_{MAP_FAILED};
+  std::size_t size_{};
+
+  void fail(const char* what) const
+  {
+    std::cerr << what << " " << name_ << ": " << std::strerror(errno) << "\n";
+  }
+
+ public:
+  TelemetryPublisher() = default;
+
+  ~TelemetryPublisher() { close(); }
+
+  // Non-copyable & Non-moveable
+  TelemetryPublisher(const TelemetryPublisher&)            = delete;
+  TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+  TelemetryPublisher(TelemetryPublisher&&)                 = delete;
+  TelemetryPublisher& operator=(TelemetryPublisher&&)      = delete;
+
+  // Returns false and prints the error when the segment can't be created
+  bool open(const std::string& name, const std::vector<std::string>& products,
+            const double nanosPerTick)
+  {
+    close();
+    name_ = name;
+    size_ = telemetrySegmentSize(products.size());
+    const int fd = createShmSegment<TelemetryHeader>(name_, telemetryMagic,
+                                                     telemetryLayoutVersion);
+    if (fd == -1) {
+      return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size_)) == -1) {
+      fail("ftruncate");
+      ::close(fd);
+      ::shm_unlink(name_.c_str());
+      return false;
+    }
+    base_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+      fail("mmap");
+      ::shm_unlink(name_.c_str());
+      return false;
+    }
+
+    auto* header           = new (base_) TelemetryHeader{};
+    header->magic_         = telemetryMagic;
+    header->layoutVersion_ = telemetryLayoutVersion;
+    header->productCount_  = static_cast<uint32_t>(products.size());
+    header->ownerPid_      = ::getpid();
+    header->nanosPerTick_  = nanosPerTick;
+    new (connection()) TelemetryConnection{};
+    for (std::size_t i{}; i < products.size(); ++i) {
+      auto* slot = new (product(i)) TelemetryProduct{};
+      const std::size_t length =
+          std::min(products[i].size(), shmProductIDSize - 1);
+      std::memcpy(slot->productID_.data(), products[i].data(), length);
+    }
+    header->ready_.store(1, std::memory_order_release);
+    return true;
+  }
+
+  // Valid until close
+  [[nodiscard]] TelemetryConnection* connection() const
+  {
+    return reinterpret_cast<TelemetryConnection*>(
+        static_cast<std::byte*>(base_) + sizeof(TelemetryHeader));
+  }
+
+  // The index-th subscribed product, valid until close
+  [[nodiscard]] TelemetryProduct* product(const std::size_t index) const
+  {
+    return reinterpret_cast<TelemetryProduct*>(
+        static_cast<std::byte*>(base_) + sizeof(TelemetryHeader)
+        + sizeof(TelemetryConnection) + index * sizeof(TelemetryProduct));
+  }
+
+  [[nodiscard]] bool isOpen() const { return base_ != MAP_FAILED; }
+
+  void close()
+  {
+    if (base_ == MAP_FAILED) {
+      return;
+    }
+    ::munmap(base_, size_);
+    ::shm_unlink(name_.c_str());
+    base_ = MAP_FAILED;
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,156 @@
+#pragma once
+// Header Guard
+
+// Reader library for the shared memory telemetry. Header only and independent
+// of the feed handler, include it with telemetry_layout.h, shm_layout.h,
+// published_top.h and latency_histogram.h. open() and close() make syscalls,
+// samples are plain loads from the mapping.
+
+#include "latency_histogram.h"
+#include "telemetry_layout.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gkp {
+
+// Copy of a TelemetryHistogram at one point in time. since() gives the
+// values recorded between two samples
+struct HistogramSample {
+  LatencyHistogram::bucket_counts counts_{};
+  uint64_t count_{};
+  uint64_t sum_{};
+  // Since the publisher started, since() can't narrow it down
+  uint64_t max_{};
+
+  void load(const TelemetryHistogram& histogram)
+  {
+    // Before the buckets, pairs with the release in record()
+    count_ = histogram.count_.load(std::memory_order_acquire);
+    sum_   = histogram.sum_.load(std::memory_order_relaxed);
+    max_   = histogram.max_.load(std::memory_order_relaxed);
+    for (std::size_t i{}; i < LatencyHistogram::bucketCount; ++i) {
+      counts_[i] = histogram.counts_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  // The earlier sample's buckets may hold records its count_ missed, so the
+  // delta's count is the sum of its buckets, which percentile() ranks against
+  [[nodiscard]] HistogramSample since(const HistogramSample& earlier) const
+  {
+    HistogramSample delta;
+    for (std::size_t i{}; i < LatencyHistogram::bucketCount; ++i) {
+      delta.counts_[i] = counts_[i] - earlier.counts_[i];
+      delta.count_ += delta.counts_[i];
+    }
+    delta.sum_ = sum_ - earlier.sum_;
+    delta.max_ = max_;
+    return delta;
+  }
+
+  [[nodiscard]] double mean() const
+  {
+    return (count_ == 0)
+               ? 0.0
+               : static_cast<double>(sum_) / static_cast<double>(count_);
+  }
+
+  // Upper bound of the bucket holding the quantile
+  [[nodiscard]] uint64_t percentile(const double quantile) const
+  {
+    return LatencyHistogram::percentileOf(counts_, count_, quantile);
+  }
+};
+
+class TelemetryReader {
+ private:
+  const void* base_{MAP_FAILED};
+  std::size_t size_{};
+
+  [[nodiscard]] const TelemetryHeader& header() const
+  {
+    return *static_cast<const TelemetryHeader*>(base_);
+  }
+
+ public:
+  TelemetryReader() = default;
+
+  ~TelemetryReader() { close(); }
+
+  // Non-copyable & Non-moveable
+  TelemetryReader(const TelemetryReader&)            = delete;
+  TelemetryReader& operator=(const TelemetryReader&) = delete;
+  TelemetryReader(TelemetryReader&&)                 = delete;
+  TelemetryReader& operator=(TelemetryReader&&)      = delete;
+
+  // Maps the segment read only. False when it doesn't exist, isn't ready yet
+  // or was written by a different layout version
+  bool open(const char* name)
+  {
+    close();
+    const int fd = ::shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+      return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) == -1
+        || static_cast<std::size_t>(info.st_size) < sizeof(TelemetryHeader))
+    {
+      ::close(fd);
+      return false;
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    base_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+      return false;
+    }
+    const TelemetryHeader& head = header();
+    if (head.ready_.load(std::memory_order_acquire) == 0
+        || head.magic_ != telemetryMagic
+        || head.layoutVersion_ != telemetryLayoutVersion
+        || size_ < telemetrySegmentSize(head.productCount_))
+    {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close()
+  {
+    if (base_ != MAP_FAILED) {
+      ::munmap(const_cast<void*>(base_), size_);
+      base_ = MAP_FAILED;
+    }
+  }
+
+  [[nodiscard]] bool isOpen() const { return base_ != MAP_FAILED; }
+
+  [[nodiscard]] std::size_t productCount() const
+  {
+    return header().productCount_;
+  }
+
+  [[nodiscard]] double nanosPerTick() const { return header().nanosPerTick_; }
+
+  [[nodiscard]] const TelemetryConnection& connection() const
+  {
+    return *reinterpret_cast<const TelemetryConnection*>(
+        static_cast<const std::byte*>(base_) + sizeof(TelemetryHeader));
+  }
+
+  [[nodiscard]] const TelemetryProduct& product(const std::size_t index) const
+  {
+    return *reinterpret_cast<const TelemetryProduct*>(
+        static_cast<const std::byte*>(base_) + sizeof(TelemetryHeader)
+        + sizeof(TelemetryConnection) + index * sizeof(TelemetryProduct));
+  }
+};
+}  // namespace gkp
@@ -0,0 +1,65 @@
+#pragma once
+// Header Guard
+
+#include "common.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace gkp {
+
+// Cheap timestamps for latency statistics. On x86 now() reads the time stamp
+// counter, which is invariant and synchronized across cores on the CPUs this
+// targets, and the constructor measures its rate against steady_clock.
+// Elsewhere it falls back to steady_clock nanoseconds. Reads aren't
+// serialized, which is fine for anything longer than a few cycles.
+class TscClock {
+ private:
+  double nanosPerTick_{1.0};
+
+ public:
+  // Blocks for about calibration while it counts ticks
+  explicit TscClock(
+      const Duration calibration = std::chrono::milliseconds{10})
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    const auto startTime    = Clock::now();
+    const uint64_t startTsc = now();
+    std::this_thread::sleep_for(calibration);
+    const uint64_t endTsc = now();
+    const auto endTime    = Clock::now();
+    const auto nanos =
+        std::chrono::duration_cast<Duration>(endTime - startTime).count();
+    if (endTsc > startTsc) {
+      nanosPerTick_ = static_cast<double>(nanos)
+                      / static_cast<double>(endTsc - startTsc);
+    }
+#else
+    static_cast<void>(calibration);
+#endif
+  }
+
+  [[nodiscard]] static uint64_t now()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<Duration>(Clock::now().time_since_epoch())
+            .count());
+#endif
+  }
+
+  [[nodiscard]] double nanosPerTick() const { return nanosPerTick_; }
+
+  [[nodiscard]] uint64_t toNanos(const uint64_t ticks) const
+  {
+    return static_cast<uint64_t>(static_cast<double>(ticks) * nanosPerTick_);
+  }
+};
+}  // namespace gkp
@@ -1,7 +1,6 @@
 #pragma once
 // Header Guard
 
-#include <boost/asio/buffers_iterator.hpp>
 #include <boost/asio/connect.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl.hpp>
@@ -17,6 +16,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace beast     = boost::beast;
@@ -30,7 +30,8 @@ namespace gkp {
 class Websocket : public std::enable_shared_from_this<Websocket> {
  private:
   using tcp             = boost::asio::ip::tcp;
-  using parser_callback = std::function<void(std::string&)>;
+  // The view is over the read buffer and only valid during the call
+  using parser_callback = std::function<void(std::string_view)>;
 
   tcp::resolver resolver_;
   websocket::stream<ssl::stream<beast::tcp_stream>> ws_;
@@ -150,10 +151,14 @@ class Websocket : public std::enable_shared_from_this<Websocket> {
     }
 
     if (buffer_.size()) {
-      auto bufData = buffer_.data();
-      std::string json(buffers_begin(bufData), buffers_end(bufData));
-      parserCallback_(json);
-      buffer_.clear();
+      // The parser reads up to a null past the frame, as with a std::string.
+      // Write it into spare capacity, which may move the frame, so take the
+      // view afterwards. Capacity is kept, so steady state doesn't allocate
+      *static_cast<char*>(buffer_.prepare(1).data()) = '\0';
+      const auto frame = buffer_.cdata();
+      parserCallback_(std::string_view{static_cast<const char*>(frame.data()),
+                                       frame.size()});
+      buffer_.consume(buffer_.size());
     }
 
     auto callback = (restart_) ? &Websocket::on_close : &Websocket::on_write;
@@ -0,0 +1,170 @@
+#include "telemetry_reader.h"
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Everything the report subtracts, taken once per interval
+struct Sample {
+  uint64_t frames_{};
+  uint64_t fullWaits_{};
+  uint64_t resnapshots_{};
+  gkp::HistogramSample queueDepth_;
+  struct Product {
+    uint64_t snapshots_{};
+    gkp::HistogramSample l2update_;
+    gkp::HistogramSample orderbookUpdate_;
+  };
+  std::vector<Product> products_;
+
+  void load(const gkp::TelemetryReader& reader)
+  {
+    const gkp::TelemetryConnection& connection = reader.connection();
+    frames_      = connection.frames_.load(std::memory_order_relaxed);
+    fullWaits_   = connection.fullWaits_.load(std::memory_order_relaxed);
+    resnapshots_ = connection.resnapshots_.load(std::memory_order_relaxed);
+    queueDepth_.load(connection.queueDepth_);
+    products_.resize(reader.productCount());
+    for (std::size_t i{}; i < products_.size(); ++i) {
+      const gkp::TelemetryProduct& product = reader.product(i);
+      products_[i].snapshots_ =
+          product.snapshots_.load(std::memory_order_relaxed);
+      products_[i].l2update_.load(product.l2update_);
+      products_[i].orderbookUpdate_.load(product.orderbookUpdate_);
+    }
+  }
+};
+
+double
+perSecond(const uint64_t count, const double seconds)
+{
+  return (seconds <= 0.0) ? 0.0 : static_cast<double>(count) / seconds;
+}
+
+void
+printLatency(const std::string_view name, const gkp::HistogramSample& delta,
+             const double scale)
+{
+  const auto scaled = [scale](const uint64_t value) {
+    return static_cast<uint64_t>(static_cast<double>(value) * scale);
+  };
+  std::cout << name << " (ns): Mean " << delta.mean() * scale << ", 50% "
+            << scaled(delta.percentile(0.5)) << ", 99% "
+            << scaled(delta.percentile(0.99)) << ", 99.9% "
+            << scaled(delta.percentile(0.999)) << '\n';
+}
+
+// Rates and percentiles over the interval, counts since the publisher
+// started
+void
+printReport(const gkp::TelemetryReader& reader, const Sample& now,
+            const Sample& last, const double seconds)
+{
+  const double scale = reader.nanosPerTick();
+  std::cout << "\nFrames/s:    " << perSecond(now.frames_ - last.frames_,
+                                              seconds)
+            << '\n';
+  std::cout << "Full Waits:  " << now.fullWaits_ << '\n';
+  std::cout << "Resnapshots: " << now.resnapshots_ << '\n';
+  const uint64_t readyNanos = reader.connection().allBooksReadyNanos_.load(
+      std::memory_order_relaxed);
+  if (readyNanos != 0) {
+    std::cout << "All Books Ready (ms): " << readyNanos / 1'000'000 << '\n';
+  }
+  const gkp::HistogramSample depth = now.queueDepth_.since(last.queueDepth_);
+  if (depth.count_ != 0) {
+    std::cout << "Queue Depth: Mean " << depth.mean() << ", 99% "
+              << depth.percentile(0.99) << ", Max " << depth.max_ << '\n';
+  }
+
+  for (std::size_t i{}; i < now.products_.size(); ++i) {
+    const gkp::TelemetryProduct& shared = reader.product(i);
+    const Sample::Product& product      = now.products_[i];
+    const gkp::HistogramSample l2update =
+        product.l2update_.since(last.products_[i].l2update_);
+    std::cout << '\n'
+              << shared.productID_.data()
+              << " - L2 Messages/s: " << perSecond(l2update.count_, seconds)
+              << ", Snapshots: " << product.snapshots_ << '\n';
+    if (product.snapshots_ != 0) {
+      std::cout << "Last Snapshot (ns): "
+                << static_cast<uint64_t>(
+                       static_cast<double>(shared.snapshotTicks_.load(
+                           std::memory_order_relaxed))
+                       * scale)
+                << '\n';
+    }
+    if (l2update.count_ != 0) {
+      printLatency("L2 Message Processing", l2update, scale);
+      printLatency(
+          "Orderbook Update",
+          product.orderbookUpdate_.since(last.products_[i].orderbookUpdate_),
+          scale);
+    }
+  }
+  std::cout.flush();
+}
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  constexpr auto helpOpt     = "help";
+  constexpr auto nameOpt     = "telemetry-shm";
+  constexpr auto intervalOpt = "interval-ms";
+
+  namespace progOpt = boost::program_options;
+  progOpt::options_description desc("Options");
+  desc.add_options()(helpOpt, "Print help message.")(
+      nameOpt,
+      progOpt::value<std::string>()->default_value("/coinbase_telemetry"),
+      "POSIX shared memory segment the feed handler publishes to, "
+      "<name>.<shard> when sharded.")(
+      intervalOpt, progOpt::value<std::size_t>()->default_value(1000),
+      "Milliseconds between reports.");
+
+  progOpt::variables_map varsMap;
+  progOpt::store(progOpt::parse_command_line(argc, argv, desc), varsMap);
+
+  if (varsMap.count(helpOpt)) {
+    std::cout << "./telemetry-reader:\n" << desc << '\n';
+    return 0;
+  }
+
+  const std::string name = varsMap[nameOpt].as<std::string>();
+  const std::chrono::milliseconds interval{
+      varsMap[intervalOpt].as<std::size_t>()};
+
+  // The feed handler may not be up yet
+  gkp::TelemetryReader reader;
+  while (!reader.open(name.c_str())) {
+    std::cout << "Waiting for " << name << "...\n";
+    std::this_thread::sleep_for(interval);
+  }
+  std::cout << "Reading " << name << ", " << reader.productCount()
+            << " products.\nPress Ctrl+C to stop.\n";
+
+  Sample last;
+  last.load(reader);
+  auto lastTime = std::chrono::steady_clock::now();
+  while (true) {
+    std::this_thread::sleep_for(interval);
+    Sample now;
+    now.load(reader);
+    const auto nowTime = std::chrono::steady_clock::now();
+    printReport(reader, now, last,
+                std::chrono::duration<double>(nowTime - lastTime).count());
+    last     = std::move(now);
+    lastTime = nowTime;
+  }
+}